@@ -0,0 +1,250 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file inet_bench.c
+ * This file benchmarks the wrapper's inet_pton(), inet_ntop(), inet_aton()
+ * and inet_ntoa_r() against the sscanf() and sprintf() based conversions
+ * they replace, and the bulk byte order conversions of netinet/in.h against
+ * the per field SimpleLink calls.  Link it with the wrapper library and run
+ * it on the target, results are reported with printf().
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/** number of conversions timed for each method */
+#define ITERATIONS (100000)
+
+/** addresses converted, cycled through by each benchmark */
+static const char *const addresses[] =
+{
+    "0.0.0.0",
+    "10.0.0.1",
+    "127.0.0.1",
+    "172.16.254.3",
+    "192.168.1.100",
+    "255.255.255.255",
+    "8.8.4.4",
+    "100.64.12.200",
+};
+
+/** number of entries in addresses */
+#define ADDRESS_COUNT (sizeof(addresses) / sizeof(addresses[0]))
+
+/** number of fields in a simulated packet */
+#define FIELDS (32)
+
+/** keeps the compiler from discarding the conversions */
+static volatile uint32_t sink;
+
+/** Parse an address the naive way.
+ * @param src address text
+ * @param addr parsed address, network byte order
+ * @return 1 on success, else 0
+ */
+static int naive_pton(const char *src, uint32_t *addr)
+{
+    unsigned a, b, c, d;
+    char tail;
+
+    if (sscanf(src, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 ||
+        a > 255 || b > 255 || c > 255 || d > 255)
+    {
+        return 0;
+    }
+
+    *addr = htonl((a << 24) | (b << 16) | (c << 8) | d);
+    return 1;
+}
+
+/** Format an address the naive way.
+ * @param addr address, network byte order
+ * @param dst destination, at least INET_ADDRSTRLEN bytes
+ */
+static void naive_ntop(uint32_t addr, char *dst)
+{
+    const uint8_t *octet = (const uint8_t*)&addr;
+
+    sprintf(dst, "%u.%u.%u.%u", octet[0], octet[1], octet[2], octet[3]);
+}
+
+/** Report the time taken by a benchmark.
+ * @param name name of the benchmark
+ * @param start clock() value at the start
+ */
+static void report(const char *name, clock_t start)
+{
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%-24s %8.1f ns/call\n", name, seconds * 1e9 / ITERATIONS);
+}
+
+/** Check that the wrapper and the naive conversions agree.
+ * @return 0 if they do, else 1
+ */
+static int verify(void)
+{
+    for (unsigned i = 0; i < ADDRESS_COUNT; ++i)
+    {
+        struct in_addr addr;
+        uint32_t naive;
+        char buf[INET_ADDRSTRLEN];
+        char naive_buf[INET_ADDRSTRLEN];
+
+        if (inet_pton(AF_INET, addresses[i], &addr) != 1 ||
+            !naive_pton(addresses[i], &naive) || addr.s_addr != naive)
+        {
+            printf("inet_pton() mismatch for %s\n", addresses[i]);
+            return 1;
+        }
+        naive_ntop(naive, naive_buf);
+        if (inet_ntop(AF_INET, &addr, buf, sizeof(buf)) == NULL ||
+            strcmp(buf, naive_buf) != 0 || strcmp(buf, addresses[i]) != 0)
+        {
+            printf("inet_ntop() mismatch for %s\n", addresses[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/** Entry point.
+ * @return 0 on success, else 1
+ */
+int main(void)
+{
+    struct in_addr addr;
+    char buf[INET_ADDRSTRLEN];
+    clock_t start;
+
+    if (verify())
+    {
+        return 1;
+    }
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        uint32_t naive;
+        naive_pton(addresses[i % ADDRESS_COUNT], &naive);
+        sink += naive;
+    }
+    report("sscanf()", start);
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        inet_pton(AF_INET, addresses[i % ADDRESS_COUNT], &addr);
+        sink += addr.s_addr;
+    }
+    report("inet_pton()", start);
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        inet_aton(addresses[i % ADDRESS_COUNT], &addr);
+        sink += addr.s_addr;
+    }
+    report("inet_aton()", start);
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        naive_ntop(i * 2654435761UL, buf);
+        sink += buf[0];
+    }
+    report("sprintf()", start);
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        addr.s_addr = i * 2654435761UL;
+        inet_ntop(AF_INET, &addr, buf, sizeof(buf));
+        sink += buf[0];
+    }
+    report("inet_ntop()", start);
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        addr.s_addr = i * 2654435761UL;
+        inet_ntoa_r(addr, buf, sizeof(buf));
+        sink += buf[0];
+    }
+    report("inet_ntoa_r()", start);
+
+    uint16_t shorts[FIELDS];
+    uint32_t longs[FIELDS];
+    memset(shorts, 0x5A, sizeof(shorts));
+    memset(longs, 0xA5, sizeof(longs));
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        for (unsigned j = 0; j < FIELDS; ++j)
+        {
+            shorts[j] = sl_Htons(shorts[j]);
+        }
+        sink += shorts[i % FIELDS];
+    }
+    report("sl_Htons() x32", start);
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        htons_array(shorts, FIELDS);
+        sink += shorts[i % FIELDS];
+    }
+    report("htons_array(32)", start);
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        for (unsigned j = 0; j < FIELDS; ++j)
+        {
+            longs[j] = sl_Htonl(longs[j]);
+        }
+        sink += longs[i % FIELDS];
+    }
+    report("sl_Htonl() x32", start);
+
+    start = clock();
+    for (unsigned i = 0; i < ITERATIONS; ++i)
+    {
+        htonl_array(longs, FIELDS);
+        sink += longs[i % FIELDS];
+    }
+    report("htonl_array(32)", start);
+
+    return 0;
+}
@@ -34,12 +34,67 @@
 #ifndef _ARPA_INET_H_
 #define _ARPA_INET_H_
 
+#include <sys/socket.h>
 #include <netinet/in.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Size of a buffer that holds any IPv4 address in dotted decimal notation,
+ * including the terminating NUL.
+ */
+#define INET_ADDRSTRLEN (16)
+
+/** Convert an address from text to binary form.
+ * @param af address family, only AF_INET is supported
+ * @param src address in dotted decimal notation, d.d.d.d
+ * @param dst destination, a struct in_addr for AF_INET
+ * @return 1 on success, 0 if src is not a valid address, -1 with errno set
+ *         to EAFNOSUPPORT if af is not supported
+ */
+int inet_pton(int af, const char *src, void *dst);
+
+/** Convert an address from binary to text form.
+ * @param af address family, only AF_INET is supported
+ * @param src address, a struct in_addr for AF_INET
+ * @param dst destination buffer
+ * @param size size of dst in bytes, INET_ADDRSTRLEN always suffices
+ * @return dst on success, else NULL with errno set, ENOSPC if dst is too
+ *         small
+ */
+const char *inet_ntop(int af, const void *src, char *dst, socklen_t size);
+
+/** Convert an IPv4 address in numbers-and-dots notation, where each part
+ * may be decimal, octal or hexadecimal and fewer than four parts may be
+ * given, to binary form.
+ * @param cp address text
+ * @param inp destination, may be NULL to only validate cp
+ * @return non-zero if cp is valid, else 0
+ */
+int inet_aton(const char *cp, struct in_addr *inp);
+
+/** Convert an IPv4 address in numbers-and-dots notation to binary form.
+ * @param cp address text
+ * @return address in network byte order, INADDR_NONE if cp is not valid
+ */
+in_addr_t inet_addr(const char *cp);
+
+/** Convert an IPv4 address to dotted decimal notation.  This is not multi-
+ * thread safe, please use @ref inet_ntoa_r() or @ref inet_ntop() instead.
+ * @param in address
+ * @return pointer to a static buffer holding the text
+ */
+char *inet_ntoa(struct in_addr in);
+
+/** Reentrant version of @ref inet_ntoa().
+ * @param in address
+ * @param buf destination buffer
+ * @param size size of buf in bytes, INET_ADDRSTRLEN always suffices
+ * @return buf on success, else NULL with errno set to ENOSPC
+ */
+char *inet_ntoa_r(struct in_addr in, char *buf, socklen_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,6 +34,7 @@
 #ifndef _NETDB_H_
 #define _NETDB_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -63,6 +64,42 @@ struct hostent
  */
 struct hostent *gethostbyname(const char *name);
 
+/** Reentrant version of @ref gethostbyname().
+ * @param name hostname to resolve
+ * @param ret host entry to fill in
+ * @param buf buffer for the data ret points to
+ * @param buflen size of buf in bytes
+ * @param result set to ret on success, else NULL
+ * @param h_errnop resolution error, on failure
+ * @return 0 if the lookup completed, check *result for success, ERANGE if
+ *         buf is too small
+ */
+int gethostbyname_r(const char *name, struct hostent *ret, char *buf,
+                    size_t buflen, struct hostent **result, int *h_errnop);
+
+/** CC32xx extension, discard all names and services cached by the
+ * resolver.  Call this from the SimpleLink NetApp event handler when the IP
+ * address is acquired or lost, since names may resolve differently on the
+ * new network.
+ */
+void dns_cache_flush(void);
+
+/** CC32xx extension, write the addresses held by the resolver cache to the
+ * SimpleLink file system, for dns_cache_load() to pick up after a reset.
+ * Only available if SimpleLink is built with SL_INC_NVMEM_PKG.
+ * @return 0 upon success, -1 on error with errno set appropriately
+ */
+int dns_cache_save(void);
+
+/** CC32xx extension, seed the resolver cache from the file written by
+ * dns_cache_save().  Call this once the network processor is started.
+ * Loaded names are answered at once with their saved address and confirmed
+ * with a lookup in the background, on the getaddrinfo_async() thread.
+ * @return number of names loaded, -1 on error with errno set appropriately
+ */
+int dns_cache_load(void);
+
+#define NETDB_INTERNAL -1
 #define HOST_NOT_FOUND 1
 #define TRY_AGAIN      2
 #define NO_RECOVERY    3
@@ -83,29 +120,93 @@ struct addrinfo
     struct addrinfo *ai_next; /**< Pointer to next in list */
 };
 
+/** a NULL nodename yields INADDR_ANY, for bind(), instead of
+ * INADDR_LOOPBACK
+ */
+#define AI_PASSIVE     0x0001
+
+/** return the canonical name in ai_canonname of the first entry */
+#define AI_CANONNAME   0x0002
+
+/** nodename must be a numeric address, never ask DNS */
+#define AI_NUMERICHOST 0x0004
+
+/** servname must be a numeric port */
+#define AI_NUMERICSERV 0x0400
+
 /** Translate any addrinfo error codes to a human readable string.
  * @param ecode error code to translate
  */
 const char *gai_strerror (int ecode);
 
 /** Free a struct addrinfo previously allocated by a call to getaddrinfo()
- * @param ai struct addrinfo to free
+ * @param ai head of the struct addrinfo list to free, the whole list is
+ *           released at once
  */
 void freeaddrinfo(struct addrinfo *ai);
 
-/** Given nodename and servname, identify a host and service.
+/** Given nodename and servname, identify a host and service.  Unless the
+ * hints name a socket type, one entry is returned for each of SOCK_STREAM
+ * and SOCK_DGRAM.  The result is a single allocation.  A NULL nodename or
+ * a dotted decimal address is handled without the network processor, as
+ * is servname, which must be a decimal port number.
  * @param nodename typically a host name
  * @param servname typically a port name
- * @param hints any hints to best bind the results to
+ * @param hints any hints to best bind the results to, may be NULL
  * @param res resulting information
- * @return 0 on success, -1 on failure
+ * @return 0 on success, else an EAI_* error code
  */
 int getaddrinfo(const char *nodename, const char *servname,
                 const struct addrinfo *hints,
                 struct addrinfo **res);
 
+/** CC32xx extension, completion of @ref getaddrinfo_async().
+ * @param error 0 on success, else an EAI_* error code
+ * @param res resulting information on success, else NULL, the callee
+ *            releases it with freeaddrinfo()
+ * @param context value given to @ref getaddrinfo_async()
+ */
+typedef void (*getaddrinfo_callback_t)(int error, struct addrinfo *res,
+                                       void *context);
+
+/** CC32xx extension, resolve like @ref getaddrinfo() without blocking the
+ * caller.  Requests are served in order by a wrapper owned thread, which
+ * also runs the callback, so the callback must not block for long.
+ * @param nodename typically a host name
+ * @param servname typically a port name
+ * @param hints any hints to best bind the results to, may be NULL
+ * @param callback called once with the result, must not be NULL
+ * @param context value passed to the callback
+ * @return 0 if the request has been queued, else an EAI_* error code, in
+ *         which case the callback is not called
+ */
+int getaddrinfo_async(const char *nodename, const char *servname,
+                      const struct addrinfo *hints,
+                      getaddrinfo_callback_t callback, void *context);
+
+/** CC32xx extension, resolve a DNS-SD service instance with mDNS, e.g.
+ * "printer._ipp._tcp.local".  The address and port of the instance are
+ * returned like @ref getaddrinfo() returns them, its TXT record in txt.
+ * Answers are cached and refreshed in the background before they expire,
+ * so repeated lookups do not repeat the multicast query.
+ * @param service service instance name
+ * @param hints any hints to best bind the results to, may be NULL
+ * @param res resulting information, released with freeaddrinfo()
+ * @param txt buffer for the TXT record data, may be NULL
+ * @param txtlen size of txt in bytes on entry, length of the TXT record
+ *               data on return, of which at most the size of txt is
+ *               copied, may be NULL if txt is NULL
+ * @return 0 on success, else an EAI_* error code
+ */
+int getaddrinfo_service(const char *service, const struct addrinfo *hints,
+                        struct addrinfo **res, char *txt, size_t *txtlen);
+
+# define EAI_NONAME   -2    /**< NAME or SERVICE is unknown */
 # define EAI_AGAIN    -3    /**< Temporary failure in name resolution */
 # define EAI_FAIL     -4    /**< Non-recoverable failure in name res */
+# define EAI_FAMILY   -6    /**< ai_family not supported */
+# define EAI_SOCKTYPE -7    /**< ai_socktype not supported */
+# define EAI_SERVICE  -8    /**< SERVICE not supported for socket type */
 # define EAI_MEMORY   -10   /**< Memory allocation failure */
 
 #ifdef __cplusplus
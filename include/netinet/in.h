@@ -41,6 +41,9 @@
  */
 #include "socket.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -71,6 +74,9 @@ struct sockaddr_in
 /** Broadcast IP address */
 #define INADDR_BROADCAST (0xFFFFFFFF)
 
+/** Invalid IP address, returned by inet_addr() on error */
+#define INADDR_NONE      (0xFFFFFFFF)
+
 /** Loopback IP address */
 #define INADDR_LOOPBACK  (0x7F000001)
 
@@ -83,6 +89,51 @@ struct sockaddr_in
 /** Raw Socket */
 #define IPPROTO_RAW (255)
 
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+/// Reverses the byte order of a 32-bit value, a constant for a constant.
+#define BSD_BSWAP32(x) __builtin_bswap32(x)
+/// Reverses the byte order of a 16-bit value, a constant for a constant.
+#define BSD_BSWAP16(x) __builtin_bswap16(x)
+#elif defined(__TI_COMPILER_VERSION__) && defined(__little_endian__)
+/** Reverse the byte order of a 32-bit value.  Being inline, the swap of a
+ * constant is folded at compile time.
+ * @param x value to swap
+ * @return x with its byte order reversed
+ */
+static inline uint32_t bsd_bswap32(uint32_t x)
+{
+    return (x << 24) | ((x & 0x0000FF00) << 8) |
+           ((x >> 8) & 0x0000FF00) | (x >> 24);
+}
+
+/** Reverse the byte order of a 16-bit value.  Being inline, the swap of a
+ * constant is folded at compile time.
+ * @param x value to swap
+ * @return x with its byte order reversed
+ */
+static inline uint16_t bsd_bswap16(uint16_t x)
+{
+    return (uint16_t)((x << 8) | (x >> 8));
+}
+
+/// Reverses the byte order of a 32-bit value.
+#define BSD_BSWAP32(x) bsd_bswap32(x)
+/// Reverses the byte order of a 16-bit value.
+#define BSD_BSWAP16(x) bsd_bswap16(x)
+#endif
+
+#if defined(BSD_BSWAP32)
+/// Converts a network endian long value to host endian.
+#define ntohl(x)   BSD_BSWAP32(x)
+/// Converts a network endian short value to host endian.
+#define ntohs(x)   BSD_BSWAP16(x)
+/// Converts a host endian long value to network endian.
+#define htonl(x)   BSD_BSWAP32(x)
+/// Converts a host endian short value to network endian.
+#define htons(x)   BSD_BSWAP16(x)
+#else
+/* byte order unknown at compile time, let SimpleLink find out */
 /// Converts a network endian long value to host endian.
 #define ntohl(x)   sl_Ntohl(x)
 /// Converts a network endian short value to host endian.
@@ -91,6 +142,26 @@ struct sockaddr_in
 #define htonl(x)   sl_Htonl(x)
 /// Converts a host endian short value to network endian.
 #define htons(x)   sl_Htons(x)
+#endif
+
+/** CC32xx extension, convert an array of 16-bit values between host and
+ * network byte order in place, e.g. the fields of a packet being encoded.
+ * @param data values to convert, need not be aligned beyond 2 bytes
+ * @param count number of values
+ */
+void htons_array(uint16_t *data, size_t count);
+
+/** CC32xx extension, convert an array of 32-bit values between host and
+ * network byte order in place.
+ * @param data values to convert
+ * @param count number of values
+ */
+void htonl_array(uint32_t *data, size_t count);
+
+/// Converts an array of network endian short values to host endian.
+#define ntohs_array(data, count) htons_array(data, count)
+/// Converts an array of network endian long values to host endian.
+#define ntohl_array(data, count) htonl_array(data, count)
 
 #ifdef __cplusplus
 }
@@ -41,6 +41,11 @@ extern "C" {
 /** don't delay send to coalesce packets */
 #define TCP_NODELAY (1)
 
+/** idle time in seconds before keepalive probes are sent, where the
+ * SimpleLink SDK supports setting it
+ */
+#define TCP_KEEPIDLE (4)
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,64 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file ioctl.h
+ * This file implements POSIX sys/ioctl.h prototypes.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#ifndef _SYS_IOCTL_H_
+#define _SYS_IOCTL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** get the number of bytes that can be received without blocking */
+#define FIONREAD (0x4004667FUL)
+
+/** set or clear non-blocking mode */
+#define FIONBIO  (0x8004667EUL)
+
+/** Control a socket.
+ * @param s the socket file descriptor
+ * @param request FIONREAD or FIONBIO
+ * @param ... pointer to an int, for FIONREAD it receives the number of bytes
+ *            that can be received without blocking, for FIONBIO non-zero
+ *            selects non-blocking mode.  FIONREAD requires SO_READAHEAD or
+ *            SO_RXDEMUX on the socket, the network processor does not tell
+ *            how much data is waiting, and fails with EOPNOTSUPP otherwise.
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error
+ */
+int ioctl(int s, unsigned long request, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SYS_IOCTL_H_ */
@@ -45,6 +45,12 @@ extern "C" {
 #endif
 
 #if defined(__TI_COMPILER_VERSION__)
+#ifndef ENOENT
+#define ENOENT            2
+#endif
+#ifndef EIO
+#define EIO               5
+#endif
 #ifndef EBADF
 #define EBADF             9
 #endif
@@ -63,9 +69,21 @@ extern "C" {
 #ifndef EMFILE
 #define EMFILE           24
 #endif
+#ifndef ENOSPC
+#define ENOSPC           28
+#endif
+#ifndef EPIPE
+#define EPIPE            32
+#endif
+#ifndef ERANGE
+#define ERANGE           34
+#endif
 #ifndef EPROTOTYPE
 #define EPROTOTYPE       91
 #endif
+#ifndef ENOPROTOOPT
+#define ENOPROTOOPT      92
+#endif
 #ifndef EPROTONOSUPPORT
 #define EPROTONOSUPPORT  93
 #endif
@@ -75,9 +93,30 @@ extern "C" {
 #ifndef EAFNOSUPPORT
 #define EAFNOSUPPORT     97
 #endif
+#ifndef ENOBUFS
+#define ENOBUFS         105
+#endif
+#ifndef ECONNRESET
+#define ECONNRESET      104
+#endif
+#ifndef ENOTCONN
+#define ENOTCONN        107
+#endif
+#ifndef ETIMEDOUT
+#define ETIMEDOUT       110
+#endif
+#ifndef ECONNREFUSED
+#define ECONNREFUSED    111
+#endif
+#ifndef EHOSTUNREACH
+#define EHOSTUNREACH    113
+#endif
 #ifndef EALREADY
 #define EALREADY        114
 #endif
+#ifndef EINPROGRESS
+#define EINPROGRESS     115
+#endif
 #ifndef SL_ENSOCK
 #define SL_ENSOCK           SL_ERROR_BSD_ENSOCK
 #endif
@@ -109,6 +148,15 @@ extern "C" {
 #ifndef SL_EALREADY
 #define SL_EALREADY         SL_ERROR_BSD_EALREADY
 #endif
+#if !defined(SL_ECONNRESET) && defined(SL_ERROR_BSD_ECONNRESET)
+#define SL_ECONNRESET       SL_ERROR_BSD_ECONNRESET
+#endif
+#if !defined(SL_ETIMEDOUT) && defined(SL_ERROR_BSD_ETIMEDOUT)
+#define SL_ETIMEDOUT        SL_ERROR_BSD_ETIMEDOUT
+#endif
+#if !defined(SL_ECONNREFUSED) && defined(SL_ERROR_BSD_ECONNREFUSED)
+#define SL_ECONNREFUSED     SL_ERROR_BSD_ECONNREFUSED
+#endif
 
 #ifndef SL_NET_APP_DNS_MALFORMED_PACKET
 #define SL_NET_APP_DNS_MALFORMED_PACKET    SL_ERROR_NET_APP_DNS_MALFORMED_PACKET
@@ -131,6 +179,19 @@ struct timeval
     uint32_t tv_sec;
     uint32_t tv_usec;
 };
+
+#ifndef O_RDWR
+#define O_RDWR            2
+#endif
+#ifndef O_NONBLOCK
+#define O_NONBLOCK   0x4000
+#endif
+#ifndef F_GETFL
+#define F_GETFL           3
+#endif
+#ifndef F_SETFL
+#define F_SETFL           4
+#endif
 #endif
 
 /** TCP Socket */
@@ -142,6 +203,11 @@ struct timeval
 /** Raw Socket */
 #define SOCK_RAW    (3)
 
+/** Unspecified address family, connect() to it dissolves a SOCK_DGRAM
+ * socket's association
+ */
+#define AF_UNSPEC   (0)
+
 /** IPv4 Socket (UDP, TCP, etc...) */
 #define AF_INET     (2)
 
@@ -158,6 +224,12 @@ struct timeval
 /** socket option to reuse address */
 #define SO_REUSEADDR (2)
 
+/** socket option to get the socket type */
+#define SO_TYPE      (3)
+
+/** socket option to get and clear the pending socket error */
+#define SO_ERROR     (4)
+
 /** socket option to enable broadcasts */
 #define SO_BROADCAST (6)
 
@@ -167,6 +239,55 @@ struct timeval
 /** socket option to set the receive window */
 #define SO_RCVBUF    (8)
 
+/** socket option to probe idle connections so that a vanished peer is
+ * reported as ETIMEDOUT or ECONNRESET, on by default on the CC32xx
+ */
+#define SO_KEEPALIVE (9)
+
+/** socket option to linger on close() for unsent data, struct linger */
+#define SO_LINGER    (13)
+
+/** socket option to set the receive timeout, struct timeval */
+#define SO_RCVTIMEO  (20)
+
+/** socket option to set the send timeout, struct timeval */
+#define SO_SNDTIMEO  (21)
+
+/** CC32xx extension, socket option to set the size in bytes of a host side
+ * read-ahead buffer for a SOCK_STREAM socket, 0 disables read-ahead.
+ */
+#define SO_READAHEAD (0x1001)
+
+/** CC32xx extension, socket option to make send() queue a copy of the data
+ * and return immediately, a wrapper owned thread transmits it.  Transmit
+ * errors are reported by the next send() or SO_ERROR.  close() waits for
+ * the queue to drain for at most the SO_LINGER timeout, else the
+ * SO_SNDTIMEO timeout, else BSD_CLOSE_DRAIN_MS, then discards the rest.
+ */
+#define SO_ASYNCSEND (0x1002)
+
+/** CC32xx extension, socket option to hand the receive side of a socket to a
+ * wrapper owned thread that queues incoming data in a host side buffer of
+ * the given size in bytes.  recv() and recvfrom() then only dequeue from
+ * host memory.  Once set, the option cannot be cleared.
+ */
+#define SO_RXDEMUX   (0x1003)
+
+/** CC32xx extension, socket option to let the wrapper size the network
+ * processor receive window from the observed receive rate, between
+ * BSD_RCVBUF_AUTO_MIN and BSD_RCVBUF_AUTO_MAX.  Setting SO_RCVBUF turns it
+ * off.
+ */
+#define SO_RCVBUFAUTO (0x1004)
+
+/** peek at incoming message without removing it from the receive queue,
+ * requires SO_READAHEAD or SO_RXDEMUX on the socket
+ */
+#define MSG_PEEK     (0x02)
+
+/** nonblocking operation for this call only */
+#define MSG_DONTWAIT (0x40)
+
 /** IPv4 socket address */
 struct sockaddr
 {
@@ -177,6 +298,22 @@ struct sockaddr
 /** type of sockaddr lenth */
 typedef uint32_t socklen_t;
 
+/** SO_LINGER option value */
+struct linger
+{
+    int l_onoff;  /**< non-zero to linger on close() */
+    int l_linger; /**< linger time in seconds, 0 resets the connection */
+};
+
+/** shutdown() further receives */
+#define SHUT_RD     (0)
+
+/** shutdown() further sends */
+#define SHUT_WR     (1)
+
+/** shutdown() further sends and receives */
+#define SHUT_RDWR   (2)
+
 /** Create an unbound socket in a communications domain.
  * @param domain specifies the communications domain in which a socket is
  *               to be created
@@ -213,6 +350,31 @@ int bind(int s, const struct sockaddr *address, socklen_t address_len);
  */
 int listen(int s, int backlog);
 
+/** Get the address a socket is bound to.  Answered from the address given
+ * to bind(), or inherited from the listening socket by accept(), without a
+ * network processor round trip.  An address the network processor chose
+ * itself is reported as INADDR_ANY, port 0.
+ * @param s the socket file descriptor
+ * @param address buffer for the address, truncated if too small
+ * @param address_len on input the size of address, on output the size of
+ *                    the address
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error
+ */
+int getsockname(int s, struct sockaddr *address, socklen_t *address_len);
+
+/** Get the address of the peer connected to a socket.  Answered from the
+ * address given to connect() or returned by accept(), without a network
+ * processor round trip.
+ * @param s the socket file descriptor
+ * @param address buffer for the address, truncated if too small
+ * @param address_len on input the size of address, on output the size of
+ *                    the address
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error, ENOTCONN if there is no peer
+ */
+int getpeername(int s, struct sockaddr *address, socklen_t *address_len);
+
 /** Accept a new connection on a socket.
  * @param s the socket file descriptor
  * @param address either a null pointer, or a pointer to a sockaddr
@@ -229,7 +391,9 @@ int listen(int s, int backlog);
  */
 int accept(int s, struct sockaddr *address, socklen_t *address_len);
 
-/** Connect a socket.
+/** Connect a socket.  On a non-blocking socket the first call fails with
+ * EINPROGRESS, further calls fail with EALREADY until the connection is
+ * established, after which a call returns 0.
  * @param s the socket file descriptor
  * @param address points to a sockaddr structure containing the peer address
  * @param address_len specifies the length of the sockaddr structure pointed
@@ -240,6 +404,8 @@ int accept(int s, struct sockaddr *address, socklen_t *address_len);
 int connect(int s, const struct sockaddr *address, socklen_t address_len);
 
 /** Receive a message from a connection-mode or connectionless-mode socket.
+ * If SO_READAHEAD is set on the socket, small reads are served from a host
+ * side buffer that is refilled with one large network processor read.
  * @param s the socket file descriptor
  * @param buffer buffer where the message should be stored
  * @param length length in bytes of the buffer pointed to by the buffer
@@ -253,6 +419,8 @@ int connect(int s, const struct sockaddr *address, socklen_t address_len);
 int recv(int s, void *buffer, size_t length, int flags);
 
 /** Initiate transmission of a message from the specified socket.
+ * If SO_ASYNCSEND is set on the socket, a copy of the message is queued and
+ * send() returns without waiting for the network processor.
  * @param s the socket file descriptor
  * @param buffer buffer containing the message to send
  * @param length length of the message in bytes
@@ -262,6 +430,113 @@ int recv(int s, void *buffer, size_t length, int flags);
  */
 int send(int s, const void *buffer, size_t length, int flags);
 
+/** CC32xx extension, receive a message into a buffer loaned from a fixed
+ * pool owned by the wrapper.  The buffer must be handed back with
+ * @ref recv_release() once the caller is done with the data.
+ * @param s the socket file descriptor
+ * @param buffer on success, set to the loaned buffer holding the message,
+ *               otherwise set to NULL
+ * @param length maximum number of bytes to receive, values larger than the
+ *               pool buffer size are truncated
+ * @param flags Specifies the type of message reception
+ * @return the length of the message in bytes, 0 if the peer has performed an
+ *         orderly shutdown, otherwise, -1 shall be returned and errno set to
+ *         indicate the error, ENOBUFS if all pool buffers are on loan,
+ *         ENOMEM if the pool could not be allocated
+ */
+int recv_zc(int s, void **buffer, size_t length, int flags);
+
+/** CC32xx extension, return a buffer loaned by @ref recv_zc() to the pool.
+ * @param buffer buffer returned by recv_zc(), NULL is ignored
+ */
+void recv_release(void *buffer);
+
+/** CC32xx extension, reference counted transmit buffer that can be queued on
+ * any number of sockets without being copied.
+ */
+struct txbuf;
+
+/** CC32xx extension, allocate a transmit buffer holding one reference.
+ * @param size size of the payload in bytes
+ * @return new buffer, or NULL with errno set to ENOMEM
+ */
+struct txbuf *txbuf_alloc(size_t size);
+
+/** CC32xx extension, access the payload of a transmit buffer.  The payload
+ * must not be modified once the buffer has been queued on a socket.
+ * @param buf transmit buffer
+ * @return pointer to the first byte of the payload
+ */
+void *txbuf_data(struct txbuf *buf);
+
+/** CC32xx extension, get the payload size of a transmit buffer.
+ * @param buf transmit buffer
+ * @return size of the payload in bytes
+ */
+size_t txbuf_size(struct txbuf *buf);
+
+/** CC32xx extension, take an additional reference to a transmit buffer.
+ * @param buf transmit buffer
+ * @return buf
+ */
+struct txbuf *txbuf_ref(struct txbuf *buf);
+
+/** CC32xx extension, release a reference to a transmit buffer, the buffer is
+ * freed when the last reference is released.
+ * @param buf transmit buffer, NULL is ignored
+ */
+void txbuf_unref(struct txbuf *buf);
+
+/** CC32xx extension, notification of a queued transmission.
+ * @param s the socket file descriptor
+ * @param error 0 if a queued buffer has been completely sent, otherwise the
+ *              errno value of the failure, in which case the socket's
+ *              transmit queue has been discarded
+ * @param context value given to @ref send_set_callback()
+ */
+typedef void (*send_callback_t)(int s, int error, void *context);
+
+/** CC32xx extension, queue a transmit buffer on a socket and transmit as
+ * much of the socket's queue as possible.  The socket takes its own
+ * reference, so the caller keeps the one it holds.
+ * @param s the socket file descriptor
+ * @param buf transmit buffer to send
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error, ENOBUFS if the socket's queue is
+ *         full
+ */
+int send_buf(int s, struct txbuf *buf);
+
+/** CC32xx extension, queue one transmit buffer on many sockets.
+ * @param sockets array of socket file descriptors
+ * @param count number of entries in sockets
+ * @param buf transmit buffer to send
+ * @return number of sockets the buffer was queued on
+ */
+int send_fanout(const int *sockets, int count, struct txbuf *buf);
+
+/** CC32xx extension, register a callback for the completion or failure of
+ * data queued by @ref send_buf(), @ref send_fanout() or an SO_ASYNCSEND
+ * send().  Callbacks from SO_ASYNCSEND sockets run on the wrapper's send
+ * thread and must not block.
+ * @param s the socket file descriptor
+ * @param callback callback, or NULL to remove it
+ * @param context value passed to the callback
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error
+ */
+int send_set_callback(int s, send_callback_t callback, void *context);
+
+/** CC32xx extension, transmit as much as possible of the buffers queued on a
+ * socket by @ref send_buf() or @ref send_fanout().  Only needed for
+ * non-blocking sockets.
+ * @param s the socket file descriptor
+ * @return number of bytes still queued, otherwise, -1 shall be returned and
+ *         errno set to indicate the error, in which case the queue is
+ *         discarded
+ */
+int send_flush(int s);
+
 /** Receive a message from a connection-mode or connectionless-mode socket.
  * @param s the socket file descriptor
  * @param buffer buffer where the message should be stored
@@ -317,6 +592,125 @@ int setsockopt(int s, int level, int option_name,
 int getsockopt(int socket, int level, int option_name,
                void *option_value, socklen_t *option_len);
 
+/** One entry of an option list for @ref setsockopts() or a
+ * @ref socket_template.
+ */
+struct sockopt
+{
+    int level;          /**< protocol level, e.g. SOL_SOCKET */
+    int name;           /**< option name, e.g. SO_RCVBUF */
+    const void *value;  /**< option value, as for setsockopt() */
+    socklen_t len;      /**< size of the option value in bytes */
+};
+
+/** CC32xx extension, description of a socket created by @ref socket_ex().
+ * The public fields are filled in by the application, which then calls
+ * @ref socket_template_init() once.  The template and everything it points
+ * to must remain valid while it is in use.
+ */
+struct socket_template
+{
+    int domain;                     /**< as for socket() */
+    int type;                       /**< as for socket() */
+    int protocol;                   /**< as for socket() */
+    const struct sockopt *options;  /**< options to set, may be NULL */
+    int option_count;               /**< number of entries in options */
+    const struct sockaddr *address; /**< address to bind to, may be NULL */
+    socklen_t address_len;          /**< length of address */
+
+    /** precomputed by socket_template_init(), private to the wrapper */
+    struct
+    {
+        int16_t domain;             /**< translated domain */
+        int16_t type;               /**< translated type */
+        int16_t protocol;           /**< translated protocol */
+        uint16_t reserved;          /**< padding */
+        uint32_t magic;             /**< SOCKET_TEMPLATE_MAGIC once
+                                     *   initialized */
+        uint32_t skip;              /**< options a new socket already has */
+        struct sockaddr address;    /**< translated bind address */
+    } sl;
+};
+
+/** Set several options on a socket.  Options that only the wrapper keeps
+ * track of cost no network processor round trip.
+ * @param s the socket file descriptor
+ * @param options options to set, in order
+ * @param count number of entries in options
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error of the first option that failed
+ */
+int setsockopts(int s, const struct sockopt *options, int count);
+
+/** value of socket_template::sl::magic set by @ref socket_template_init() */
+#define SOCKET_TEMPLATE_MAGIC 0x534B5454UL
+
+/** CC32xx extension, translate and validate a socket template once so that
+ * every @ref socket_ex() using it only talks to the network processor.
+ * Every template must pass through here before use, including templates
+ * on the stack, whose private fields start out as garbage.
+ * @param tmpl template to initialize
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error
+ */
+int socket_template_init(struct socket_template *tmpl);
+
+/** CC32xx extension, create a socket, set its options and bind it as
+ * described by a template, in one call.  On failure the partially set up
+ * socket is closed.
+ * @param tmpl template initialized by @ref socket_template_init()
+ * @return the socket file descriptor, otherwise, -1 shall be returned and
+ *         errno set to indicate the error, EINVAL if tmpl has not been
+ *         initialized
+ */
+int socket_ex(const struct socket_template *tmpl);
+
+/** CC32xx extension, get a connected TCP socket to host:port from the
+ * connection pool.  An idle connection to the same endpoint is reused if it
+ * has been idle for less than BSD_CONNPOOL_MAX_IDLE_MS, is younger than
+ * BSD_CONNPOOL_MAX_AGE_MS and has neither been closed by the peer nor
+ * received unsolicited data.  Otherwise host is resolved with getaddrinfo()
+ * and a new connection is made.  Idle connections give their socket back
+ * when the network processor runs out of sockets.
+ * @param host host name or dotted decimal address
+ * @param port port, host byte order
+ * @return the socket file descriptor, otherwise, -1 shall be returned and
+ *         errno set to indicate the error, EHOSTUNREACH if host does not
+ *         resolve
+ */
+int connpool_checkout(const char *host, uint16_t port);
+
+/** CC32xx extension, give a socket from @ref connpool_checkout() back to
+ * the connection pool.  Only pass reusable as non-zero if the exchange on
+ * the connection is complete, with the whole response read.  A socket that
+ * is not reusable, too old, shut down, holds unread data or has had its
+ * host side settings changed since connect (e.g. O_NONBLOCK, SO_RCVTIMEO,
+ * SO_ASYNCSEND) is closed rather than handed to the next borrower.
+ * @param s the socket file descriptor
+ * @param reusable non-zero to keep the connection for the next checkout
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error
+ */
+int connpool_return(int s, int reusable);
+
+/** CC32xx extension, close all idle connections of the connection pool,
+ * e.g. when the IP address is lost.
+ */
+void connpool_flush(void);
+
+/** Shut down part of a full-duplex connection.  SimpleLink cannot close one
+ * direction on the wire.  SHUT_RD only takes effect on the host, receives
+ * return 0 and buffered data is discarded.  SHUT_WR fails with EOPNOTSUPP
+ * on a SOCK_STREAM socket, on a SOCK_DGRAM socket sends then fail with
+ * EPIPE.  SHUT_RDWR closes the network processor socket right away, the
+ * descriptor stays reserved until close().
+ * @param s the socket file descriptor
+ * @param how SHUT_RD, SHUT_WR or SHUT_RDWR
+ * @return shall return 0 upon success, otherwise, -1 shall be returned and
+ *         errno set to indicate the error
+ */
+int shutdown(int s, int how);
+
 #if defined(__TI_COMPILER_VERSION__)
 /** Close a socket.
  * @param s socket to close
@@ -326,6 +720,15 @@ int getsockopt(int socket, int level, int option_name,
 int close(int s);
 #endif
 
+/** Manipulate socket file descriptor flags, only F_GETFL and F_SETFL with
+ * O_NONBLOCK are supported.
+ * @param s the socket file descriptor
+ * @param cmd F_GETFL or F_SETFL
+ * @return F_GETFL returns the flags, F_SETFL returns 0, otherwise, -1 shall
+ *         be returned and errno set to indicate the error
+ */
+int fcntl(int s, int cmd, ...);
+
 #ifdef __cplusplus
 }
 #endif
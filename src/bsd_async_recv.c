@@ -0,0 +1,454 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_async_recv.c
+ * This file implements the receive demultiplexer, which the select thread
+ * uses to pull received data off the network processor into the host side
+ * queues of SO_RXDEMUX sockets.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <errno.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** datagram staging buffer owned by the select thread */
+static uint8_t *dgram_buf;
+
+/** Copy into the free space of a socket's rx_buf, must be called with the
+ * critical section held and enough free space available.
+ * @param sock host side socket state
+ * @param data data to copy
+ * @param length number of bytes to copy
+ */
+static void ring_put(struct bsd_socket *sock, const void *data, size_t length)
+{
+    unsigned tail = (sock->rx_head + sock->rx_count) % sock->rx_size;
+    size_t first = sock->rx_size - tail;
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(sock->rx_buf + tail, data, first);
+    memcpy(sock->rx_buf, (const uint8_t*)data + first, length - first);
+    sock->rx_count += length;
+}
+
+/** Copy out of a socket's rx_buf without consuming, must be called with the
+ * critical section held.
+ * @param sock host side socket state
+ * @param offset offset from the oldest buffered byte
+ * @param data destination
+ * @param length number of bytes to copy
+ */
+static void ring_peek(struct bsd_socket *sock, size_t offset, void *data,
+                      size_t length)
+{
+    unsigned head = (sock->rx_head + offset) % sock->rx_size;
+    size_t first = sock->rx_size - head;
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(data, sock->rx_buf + head, first);
+    memcpy((uint8_t*)data + first, sock->rx_buf, length - first);
+}
+
+/** Consume bytes from a socket's rx_buf, must be called with the critical
+ * section held.
+ * @param sock host side socket state
+ * @param length number of bytes to consume
+ */
+static void ring_drop(struct bsd_socket *sock, size_t length)
+{
+    sock->rx_head = (sock->rx_head + length) % sock->rx_size;
+    sock->rx_count -= length;
+}
+
+/** Receive one datagram into a socket's queue.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @return 0 upon success, or -1 with errno set on error
+ */
+static int demux_dgram(int s, struct bsd_socket *sock)
+{
+    SlSockAddrIn_t sl_addr;
+    SlSocklen_t sl_addrlen = sizeof(sl_addr);
+
+    int result = sl_RecvFrom(s, dgram_buf, BSD_RX_DGRAM_MAX, 0,
+                             (SlSockAddr_t*)&sl_addr, &sl_addrlen);
+    if (result < 0)
+    {
+        return bsd_recv_error(result);
+    }
+
+    struct bsd_dgram_hdr hdr;
+    hdr.length = result;
+    hdr.port = sl_addr.sin_port;
+    hdr.addr = sl_addr.sin_addr.s_addr;
+
+    unsigned long key = bsd_lock();
+    if (sock->shut & BSD_SHUT_RD)
+    {
+        /* shut down for reading, discard */
+    }
+    else if (bsd_socket_dgram_peer(sock) &&
+             !bsd_socket_peer_match(sock, &sl_addr))
+    {
+        /* not from the connected peer, discard */
+    }
+    else if (sock->rx_size - sock->rx_count >= sizeof(hdr) + result)
+    {
+        ring_put(sock, &hdr, sizeof(hdr));
+        ring_put(sock, dgram_buf, result);
+    }
+    /* else the queue overflowed, drop it like a full socket buffer would */
+    bsd_unlock(key);
+
+    return 0;
+}
+
+/** Test if a socket's queue has room for another read.
+ * @param sock host side socket state
+ * @return non-zero if the socket should be polled
+ */
+static int demux_has_room(struct bsd_socket *sock)
+{
+    unsigned space = sock->rx_size - sock->rx_count;
+
+    if (sock->type == SOCK_STREAM)
+    {
+        return space > 0;
+    }
+    return space >= sizeof(struct bsd_dgram_hdr) + BSD_RX_DGRAM_MAX;
+}
+
+/*
+ * bsd_async_recv_fds()
+ */
+int bsd_async_recv_fds(SlFdSet_t *readfds)
+{
+    int nfds = 0;
+
+    SL_FD_ZERO(readfds);
+    for (int s = 0; s < SL_MAX_SOCKETS; ++s)
+    {
+        struct bsd_socket *sock = &bsd_sockets[s];
+        if (sock->rx_demux && !sock->rx_eof && demux_has_room(sock))
+        {
+            SL_FD_SET(s, readfds);
+            nfds = s + 1;
+        }
+    }
+    return nfds;
+}
+
+/*
+ * bsd_async_recv_service()
+ */
+void bsd_async_recv_service(int nfds, SlFdSet_t *demux, SlFdSet_t *readfds)
+{
+    for (int s = 0; s < nfds && s < SL_MAX_SOCKETS; ++s)
+    {
+        struct bsd_socket *sock = &bsd_sockets[s];
+
+        if (!SL_FD_ISSET(s, demux) || !SL_FD_ISSET(s, readfds))
+        {
+            continue;
+        }
+
+        unsigned long key = bsd_lock();
+        if (!sock->rx_demux)
+        {
+            /* closed in the meantime */
+            bsd_unlock(key);
+            continue;
+        }
+        sock->rx_busy = 1;
+        bsd_unlock(key);
+
+        int result = sock->type == SOCK_STREAM ? bsd_rx_fill(s, sock) :
+                                                 demux_dgram(s, sock);
+
+        key = bsd_lock();
+        if (result < 0 && errno != EAGAIN)
+        {
+            sock->error = errno;
+            sock->rx_eof = 1;
+        }
+        else if (result == 0 && sock->type == SOCK_STREAM)
+        {
+            sock->rx_eof = 1;
+        }
+        bsd_unlock(key);
+
+        /* close() waits for rx_busy before deleting the semaphore */
+        osi_SyncObjSignal(&sock->rx_sem);
+        sock->rx_busy = 0;
+    }
+}
+
+/*
+ * bsd_async_recv_start()
+ */
+int bsd_async_recv_start(int s, int size)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0 || sock->type == SOCK_RAW ||
+        sock->rx_demux || sock->rx_count != 0 ||
+        size < BSD_READAHEAD_MIN || size > BSD_READAHEAD_MAX ||
+        (sock->type == SOCK_DGRAM &&
+         (unsigned)size < sizeof(struct bsd_dgram_hdr) + BSD_RX_DGRAM_MAX))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (bsd_select_start() < 0)
+    {
+        return -1;
+    }
+
+    if (dgram_buf == NULL && sock->type != SOCK_STREAM)
+    {
+        uint8_t *buf = malloc(BSD_RX_DGRAM_MAX);
+        if (buf == NULL)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+        unsigned long key = bsd_lock();
+        if (dgram_buf == NULL)
+        {
+            dgram_buf = buf;
+            buf = NULL;
+        }
+        bsd_unlock(key);
+        /* NULL unless another thread won the race */
+        free(buf);
+    }
+
+    uint8_t *rx_buf = malloc(size);
+    if (rx_buf == NULL)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (sock->rx_sem == NULL && osi_SyncObjCreate(&sock->rx_sem) != OSI_OK)
+    {
+        free(rx_buf);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    free(sock->rx_buf);
+    sock->rx_buf = rx_buf;
+    sock->rx_size = size;
+    sock->rx_head = 0;
+    sock->rx_demux = 1;
+
+    bsd_select_kick();
+    return 0;
+}
+
+/*
+ * bsd_async_recv_pending()
+ */
+int bsd_async_recv_pending(struct bsd_socket *sock)
+{
+    unsigned long key = bsd_lock();
+    int pending = sock->rx_count;
+    if (pending && sock->type != SOCK_STREAM)
+    {
+        struct bsd_dgram_hdr hdr;
+        ring_peek(sock, 0, &hdr, sizeof(hdr));
+        pending = hdr.length;
+    }
+    bsd_unlock(key);
+
+    return pending;
+}
+
+/** Dequeue one datagram, must be called with the critical section held and
+ * at least one datagram queued.
+ * @param sock host side socket state
+ * @param buffer buffer where the message should be stored
+ * @param length length in bytes of the buffer
+ * @param peek true if the datagram should be left in the queue
+ * @param src_addr if not NULL, source address of a datagram
+ * @param addrlen size of src_addr
+ * @return number of bytes copied to buffer
+ */
+static int dequeue_dgram(struct bsd_socket *sock, void *buffer, size_t length,
+                         int peek, struct sockaddr *src_addr,
+                         socklen_t *addrlen)
+{
+    struct bsd_dgram_hdr hdr;
+
+    ring_peek(sock, 0, &hdr, sizeof(hdr));
+    if (length > hdr.length)
+    {
+        length = hdr.length;
+    }
+    ring_peek(sock, sizeof(hdr), buffer, length);
+    if (!peek)
+    {
+        /* the part that did not fit is discarded */
+        ring_drop(sock, sizeof(hdr) + hdr.length);
+    }
+
+    if (src_addr && addrlen && *addrlen >= sizeof(struct sockaddr_in))
+    {
+        struct sockaddr_in *addr_in = (struct sockaddr_in *)src_addr;
+        memset(addr_in, 0, sizeof(*addr_in));
+        addr_in->sin_family = AF_INET;
+        addr_in->sin_port = hdr.port;
+        addr_in->sin_addr.s_addr = hdr.addr;
+        *addrlen = sizeof(struct sockaddr_in);
+    }
+
+    return length;
+}
+
+/** Receive from the queue filled by the select thread, the caller is
+ * counted in rx_readers.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @param buffer buffer where the message should be stored
+ * @param length length in bytes of the buffer
+ * @param flags MSG_PEEK and/or MSG_DONTWAIT, or 0
+ * @param src_addr if not NULL, source address of a datagram
+ * @param addrlen size of src_addr
+ * @return see recvfrom()
+ */
+static int async_recv(int s, struct bsd_socket *sock, void *buffer,
+                      size_t length, int flags, struct sockaddr *src_addr,
+                      socklen_t *addrlen)
+{
+    uint32_t start = bsd_clock_ms();
+
+    for ( ; /* forever */ ; )
+    {
+        unsigned long key = bsd_lock();
+        if (sock->rx_count)
+        {
+            /* a full queue is left out of sl_Select() until room is made */
+            int full = !demux_has_room(sock);
+            int result;
+            if (sock->type == SOCK_STREAM)
+            {
+                bsd_unlock(key);
+                result = bsd_rx_copy(sock, buffer, length, flags & MSG_PEEK);
+            }
+            else
+            {
+                result = dequeue_dgram(sock, buffer, length, flags & MSG_PEEK,
+                                       src_addr, addrlen);
+                bsd_unlock(key);
+            }
+            if (full && !(flags & MSG_PEEK))
+            {
+                bsd_select_kick();
+            }
+            return result;
+        }
+        if (sock->rx_eof)
+        {
+            int error = sock->error;
+            if (!sock->closing)
+            {
+                /* EBADF stays for every reader of a socket being closed */
+                sock->error = 0;
+            }
+            bsd_unlock(key);
+            if (error)
+            {
+                errno = error;
+                return -1;
+            }
+            return 0;
+        }
+        bsd_unlock(key);
+
+        if ((flags & MSG_DONTWAIT) || sock->nonblock)
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+
+        if (sock->rcvtimeo)
+        {
+            /* SO_RCVTIMEO, the network processor never sees this wait */
+            uint32_t elapsed = bsd_clock_ms() - start;
+            if (elapsed >= sock->rcvtimeo)
+            {
+                errno = EAGAIN;
+                return -1;
+            }
+            osi_SyncObjWait(&sock->rx_sem, sock->rcvtimeo - elapsed);
+        }
+        else
+        {
+            osi_SyncObjWait(&sock->rx_sem, OSI_WAIT_FOREVER);
+        }
+    }
+}
+
+/*
+ * bsd_async_recv()
+ */
+int bsd_async_recv(int s, struct bsd_socket *sock, void *buffer,
+                   size_t length, int flags, struct sockaddr *src_addr,
+                   socklen_t *addrlen)
+{
+    unsigned long key = bsd_lock();
+    if (sock->rx_sem == NULL)
+    {
+        /* already closed */
+        bsd_unlock(key);
+        errno = EBADF;
+        return -1;
+    }
+    /* close() deletes rx_sem only once every reader has left */
+    ++sock->rx_readers;
+    bsd_unlock(key);
+
+    int result = async_recv(s, sock, buffer, length, flags, src_addr,
+                            addrlen);
+
+    key = bsd_lock();
+    --sock->rx_readers;
+    bsd_unlock(key);
+
+    return result;
+}
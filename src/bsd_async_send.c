@@ -0,0 +1,241 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_async_send.c
+ * This file implements the wrapper owned thread that drains the transmit
+ * queues of SO_ASYNCSEND sockets.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <errno.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** thread is not running */
+#define THREAD_STOPPED  0
+/** thread is being created */
+#define THREAD_STARTING 1
+/** thread is running */
+#define THREAD_RUNNING  2
+
+/** state of the send thread */
+static volatile uint8_t thread_state = THREAD_STOPPED;
+
+/** signaled when data has been queued for an idle send thread */
+static OsiSyncObj_t work_sem;
+
+/** signaled when the send thread has made room in a transmit queue */
+static OsiSyncObj_t space_sem;
+
+/** the send thread is waiting for sockets to become writable */
+static volatile uint8_t selecting = 0;
+
+/** set when data was queued, cuts the send thread's wait short */
+static volatile uint8_t queued = 0;
+
+/** Entry point of the send thread.  A socket whose peer stops reading must
+ * not hold up the others, so the thread only hands a socket one chunk
+ * after sl_Select() reported it writable, then moves on to the next one.
+ * @param arg unused
+ */
+static void send_thread(void *arg)
+{
+    for ( ; /* forever */ ; )
+    {
+        SlFdSet_t writefds;
+        int nfds = 0;
+
+        unsigned long key = bsd_lock();
+        queued = 0;
+        bsd_unlock(key);
+
+        SL_FD_ZERO(&writefds);
+        for (int s = 0; s < SL_MAX_SOCKETS; ++s)
+        {
+            struct bsd_socket *sock = &bsd_sockets[s];
+            if (sock->tx_async && sock->tx_count)
+            {
+                SL_FD_SET(s, &writefds);
+                nfds = s + 1;
+            }
+        }
+
+        if (nfds == 0)
+        {
+            osi_SyncObjWait(&work_sem, OSI_WAIT_FOREVER);
+            continue;
+        }
+
+        /* data queued on another socket in the meantime ends the wait */
+        selecting = 1;
+        int16_t result = bsd_select_intr(nfds, NULL, &writefds, NULL, NULL,
+                                         &queued);
+        selecting = 0;
+        if (result <= 0)
+        {
+            if (result < 0)
+            {
+                /* e.g. a socket closed under us, it drops out of the set */
+                osi_Sleep(1);
+            }
+            continue;
+        }
+
+        for (int s = 0; s < nfds; ++s)
+        {
+            struct bsd_socket *sock = &bsd_sockets[s];
+            if (!SL_FD_ISSET(s, &writefds))
+            {
+                continue;
+            }
+
+            if (bsd_txq_flush_once(s) < 0)
+            {
+                unsigned long key = bsd_lock();
+                sock->error = errno;
+                bsd_unlock(key);
+            }
+            osi_SyncObjSignal(&space_sem);
+        }
+    }
+}
+
+/*
+ * bsd_async_send_start()
+ */
+int bsd_async_send_start(void)
+{
+    unsigned long key = bsd_lock();
+    if (thread_state != THREAD_STOPPED)
+    {
+        bsd_unlock(key);
+        while (thread_state == THREAD_STARTING)
+        {
+            osi_Sleep(1);
+        }
+        if (thread_state == THREAD_STOPPED)
+        {
+            /* the thread that won the race failed to create it */
+            errno = ENOMEM;
+            return -1;
+        }
+        return 0;
+    }
+    thread_state = THREAD_STARTING;
+    bsd_unlock(key);
+
+    if (osi_SyncObjCreate(&work_sem) != OSI_OK)
+    {
+        thread_state = THREAD_STOPPED;
+        errno = ENOMEM;
+        return -1;
+    }
+    if (osi_SyncObjCreate(&space_sem) != OSI_OK)
+    {
+        osi_SyncObjDelete(&work_sem);
+        thread_state = THREAD_STOPPED;
+        errno = ENOMEM;
+        return -1;
+    }
+    if (osi_TaskCreate(send_thread, (const signed char*)"bsd_send",
+                       BSD_ASYNC_SEND_STACK_SIZE, NULL,
+                       BSD_ASYNC_SEND_PRIORITY, NULL) != OSI_OK)
+    {
+        osi_SyncObjDelete(&space_sem);
+        osi_SyncObjDelete(&work_sem);
+        thread_state = THREAD_STOPPED;
+        errno = ENOMEM;
+        return -1;
+    }
+
+    thread_state = THREAD_RUNNING;
+    return 0;
+}
+
+/*
+ * bsd_async_send_wake()
+ */
+void bsd_async_send_wake(void)
+{
+    if (thread_state == THREAD_RUNNING)
+    {
+        unsigned long key = bsd_lock();
+        queued = 1;
+        bsd_unlock(key);
+        if (selecting)
+        {
+            bsd_select_kick();
+        }
+        else
+        {
+            osi_SyncObjSignal(&work_sem);
+        }
+    }
+}
+
+/*
+ * bsd_async_send()
+ */
+int bsd_async_send(int s, const void *buffer, size_t length, int flags)
+{
+    int dontwait = (flags & MSG_DONTWAIT) || bsd_sockets[s].nonblock;
+    uint32_t timeout = bsd_sockets[s].sndtimeo;
+    uint32_t start = bsd_clock_ms();
+
+    struct txbuf *buf = txbuf_alloc(length);
+
+    if (buf == NULL)
+    {
+        return -1;
+    }
+    memcpy(txbuf_data(buf), buffer, length);
+
+    int result;
+    while ((result = bsd_txq_push(s, buf)) < 0 && errno == ENOBUFS)
+    {
+        if (dontwait || (timeout && bsd_clock_ms() - start >= timeout))
+        {
+            errno = EAGAIN;
+            break;
+        }
+        /* queue is full, wait for the send thread to drain it */
+        bsd_async_send_wake();
+        osi_SyncObjWait(&space_sem, 10);
+    }
+    txbuf_unref(buf);
+
+    if (result < 0)
+    {
+        return -1;
+    }
+
+    bsd_async_send_wake();
+    return length;
+}
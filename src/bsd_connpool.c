@@ -0,0 +1,515 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_connpool.c
+ * This file implements a pool of outbound TCP connections, keyed by
+ * host:port, layered on socket(), connect() and close().
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <ctype.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** slot is not in use */
+#define POOL_FREE 0
+/** connection is waiting in the pool */
+#define POOL_IDLE 1
+/** connection is checked out */
+#define POOL_BUSY 2
+
+/** BSD_OPT_* flags a borrower sets through setsockopt(), the rest only
+ * cache what the wrapper learned from the network processor
+ */
+#define POOL_OPTS (BSD_OPT_REUSEADDR | BSD_OPT_BROADCAST | BSD_OPT_NODELAY | \
+                   BSD_OPT_RCVBUFAUTO | BSD_OPT_LINGER)
+
+/** The host side socket settings a borrower may change, which must be
+ * back to what they were at connect before a connection is pooled again.
+ */
+struct pool_mode
+{
+    uint32_t rcvbuf;       /**< SO_RCVBUF */
+    uint32_t sndbuf;       /**< SO_SNDBUF */
+    uint32_t rcvtimeo;     /**< SO_RCVTIMEO */
+    uint32_t sndtimeo;     /**< SO_SNDTIMEO */
+    uint16_t linger;       /**< SO_LINGER timeout */
+    uint16_t keepidle;     /**< TCP_KEEPIDLE */
+    uint8_t opts;          /**< BSD_OPT_* flags in POOL_OPTS */
+    uint8_t nonblock;      /**< O_NONBLOCK */
+    uint8_t tx_async;      /**< SO_ASYNCSEND */
+    uint8_t rx_demux;      /**< SO_RXDEMUX */
+    uint8_t keepalive;     /**< SO_KEEPALIVE */
+    uint8_t reserved[3];   /**< padding, zero */
+};
+
+/** One connection known to the pool. */
+struct pool_entry
+{
+    uint32_t created;      /**< bsd_clock_ms() value at connect */
+    uint32_t returned;     /**< bsd_clock_ms() value at the last return */
+    int fd;                /**< socket file descriptor */
+    uint16_t port;         /**< port, host byte order */
+    uint8_t state;         /**< POOL_FREE, POOL_IDLE or POOL_BUSY */
+    struct pool_mode mode; /**< settings of the connection at connect */
+    char host[BSD_DNS_NAME_MAX]; /**< host name, lower case */
+};
+
+/** the connection pool */
+static struct pool_entry pool[BSD_CONNPOOL_SIZE];
+
+/** Compare a host name with the lower case host name of a pool entry.
+ * @param entry_host host name of the pool entry
+ * @param host host name, any case
+ * @param length length of host in bytes
+ * @return non-zero if the names are equal
+ */
+static int pool_host_equal(const char *entry_host, const char *host,
+                           size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (entry_host[i] != tolower((unsigned char)host[i]))
+        {
+            return 0;
+        }
+    }
+
+    return entry_host[length] == '\0';
+}
+
+/** Test if a pool entry has outlived the limits of the pool.
+ * @param entry entry to test
+ * @param now current bsd_clock_ms() value
+ * @return non-zero if the connection must not be reused
+ */
+static int pool_expired(const struct pool_entry *entry, uint32_t now)
+{
+    return now - entry->created >= BSD_CONNPOOL_MAX_AGE_MS ||
+           now - entry->returned >= BSD_CONNPOOL_MAX_IDLE_MS;
+}
+
+/** Read the settings of a socket a borrower may change.  Must be called
+ * with bsd_lock() held.
+ * @param sock host side socket state
+ * @param mode settings
+ */
+static void pool_mode_get(const struct bsd_socket *sock,
+                          struct pool_mode *mode)
+{
+    memset(mode, 0, sizeof(*mode));
+    mode->rcvbuf = sock->rcvbuf;
+    mode->sndbuf = sock->sndbuf;
+    mode->rcvtimeo = sock->rcvtimeo;
+    mode->sndtimeo = sock->sndtimeo;
+    mode->linger = sock->linger;
+    mode->keepidle = sock->keepidle;
+    mode->opts = sock->opts & POOL_OPTS;
+    mode->nonblock = sock->nonblock;
+    mode->tx_async = sock->tx_async;
+    mode->rx_demux = sock->rx_demux;
+    mode->keepalive = sock->keepalive;
+}
+
+/** Test if a returned connection is in the state the next borrower
+ * expects.  Must be called with bsd_lock() held.
+ * @param entry pool entry of the connection
+ * @return non-zero if the connection may be pooled again
+ */
+static int pool_mode_clean(const struct pool_entry *entry)
+{
+    struct bsd_socket *sock = bsd_socket_get(entry->fd);
+    struct pool_mode mode;
+
+    if (sock == NULL || sock->shut || sock->error || sock->rx_eof ||
+        sock->rx_count || sock->tx_count)
+    {
+        /* half closed, failed, or data left over from the last exchange */
+        return 0;
+    }
+
+    pool_mode_get(sock, &mode);
+    return memcmp(&mode, &entry->mode, sizeof(mode)) == 0;
+}
+
+/** Test if an idle connection can still be used.  A peer that closed the
+ * connection, reset it or sent data nobody asked for makes it unusable.
+ * The network processor is asked with a zero timeout receive, which waits
+ * its turn for the serialized sl_Select() like any other caller.
+ * @param fd socket file descriptor
+ * @return non-zero if the connection can be reused
+ */
+static int pool_alive(int fd)
+{
+    struct bsd_socket *sock = bsd_socket_get(fd);
+    if (sock && (sock->error || sock->rx_eof || sock->rx_count))
+    {
+        /* already known on the host, e.g. from the select thread */
+        return 0;
+    }
+
+    int error = errno;
+    char byte;
+
+    int result = recv(fd, &byte, 1, MSG_DONTWAIT);
+    int alive = result < 0 && errno == EAGAIN;
+
+    errno = error;
+    return alive;
+}
+
+/** Take the least recently returned idle connection out of the pool.  Must
+ * be called with bsd_lock() held.
+ * @return socket file descriptor of the connection, or -1 if none is idle
+ */
+static int pool_take_lru(void)
+{
+    struct pool_entry *lru = NULL;
+
+    for (int i = 0; i < BSD_CONNPOOL_SIZE; ++i)
+    {
+        struct pool_entry *entry = &pool[i];
+        if (entry->state == POOL_IDLE &&
+            (lru == NULL || (int32_t)(entry->returned - lru->returned) < 0))
+        {
+            lru = entry;
+        }
+    }
+
+    if (lru == NULL)
+    {
+        return -1;
+    }
+    lru->state = POOL_FREE;
+    return lru->fd;
+}
+
+/** Close the idle connections that have outlived the limits of the pool.
+ * @param now current bsd_clock_ms() value
+ */
+static void pool_sweep(uint32_t now)
+{
+    for (int i = 0; i < BSD_CONNPOOL_SIZE; ++i)
+    {
+        int fd = -1;
+
+        unsigned long key = bsd_lock();
+        struct pool_entry *entry = &pool[i];
+        if (entry->state == POOL_IDLE && pool_expired(entry, now))
+        {
+            entry->state = POOL_FREE;
+            fd = entry->fd;
+        }
+        bsd_unlock(key);
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+/** Check an idle connection to an endpoint out of the pool.
+ * @param host host name
+ * @param length length of host in bytes
+ * @param port port, host byte order
+ * @return socket file descriptor, or -1 if no usable connection is idle
+ */
+static int pool_checkout_idle(const char *host, size_t length, uint16_t port)
+{
+    for ( ; /* forever */ ; )
+    {
+        struct pool_entry *found = NULL;
+
+        unsigned long key = bsd_lock();
+        for (int i = 0; i < BSD_CONNPOOL_SIZE; ++i)
+        {
+            /* the most recently returned connection is the likeliest to
+             * still be open at the server
+             */
+            struct pool_entry *entry = &pool[i];
+            if (entry->state == POOL_IDLE && entry->port == port &&
+                pool_host_equal(entry->host, host, length) &&
+                (found == NULL ||
+                 (int32_t)(entry->returned - found->returned) > 0))
+            {
+                found = entry;
+            }
+        }
+        if (found == NULL)
+        {
+            bsd_unlock(key);
+            return -1;
+        }
+        found->state = POOL_BUSY;
+        int fd = found->fd;
+        bsd_unlock(key);
+
+        if (pool_alive(fd))
+        {
+            return fd;
+        }
+
+        /* close() releases the slot */
+        close(fd);
+    }
+}
+
+/** Keep track of a new connection, making room by closing the least
+ * recently used idle connection if the pool is full.
+ * @param fd socket file descriptor
+ * @param host host name
+ * @param length length of host in bytes
+ * @param port port, host byte order
+ */
+static void pool_track(int fd, const char *host, size_t length,
+                       uint16_t port)
+{
+    struct pool_entry *slot = NULL;
+    int evict = -1;
+
+    unsigned long key = bsd_lock();
+    for (int i = 0; i < BSD_CONNPOOL_SIZE; ++i)
+    {
+        if (pool[i].state == POOL_FREE)
+        {
+            slot = &pool[i];
+            break;
+        }
+    }
+    if (slot == NULL)
+    {
+        evict = pool_take_lru();
+        for (int i = 0; evict >= 0 && i < BSD_CONNPOOL_SIZE; ++i)
+        {
+            if (pool[i].state == POOL_FREE)
+            {
+                slot = &pool[i];
+                break;
+            }
+        }
+    }
+    if (slot)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            slot->host[i] = tolower((unsigned char)host[i]);
+        }
+        slot->host[length] = '\0';
+        slot->port = port;
+        slot->fd = fd;
+        slot->created = bsd_clock_ms();
+        slot->returned = slot->created;
+        slot->state = POOL_BUSY;
+        struct bsd_socket *sock = bsd_socket_get(fd);
+        if (sock)
+        {
+            pool_mode_get(sock, &slot->mode);
+        }
+    }
+    bsd_unlock(key);
+
+    if (evict >= 0)
+    {
+        close(evict);
+    }
+}
+
+/** Make a new connection to an endpoint.
+ * @param host host name or dotted decimal address
+ * @param port port, host byte order
+ * @return socket file descriptor, otherwise -1 with errno set
+ */
+static int pool_connect(const char *host, uint16_t port)
+{
+    struct addrinfo hints;
+    struct addrinfo *res;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    switch (getaddrinfo(host, NULL, &hints, &res))
+    {
+        case 0:
+            break;
+        case EAI_AGAIN:
+            errno = EAGAIN;
+            return -1;
+        case EAI_MEMORY:
+            errno = ENOMEM;
+            return -1;
+        default:
+            errno = EHOSTUNREACH;
+            return -1;
+    }
+    ((struct sockaddr_in*)res->ai_addr)->sin_port = htons(port);
+
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) < 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        fd = -1;
+    }
+    else if (fd >= 0)
+    {
+        /* learn the window now, so that a borrower reading SO_RCVBUF does
+         * not look like a borrower changing it
+         */
+        int rcvbuf;
+        socklen_t rcvbuf_len = sizeof(rcvbuf);
+        getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &rcvbuf_len);
+    }
+
+    freeaddrinfo(res);
+    return fd;
+}
+
+/*
+ * ::connpool_checkout()
+ */
+int connpool_checkout(const char *host, uint16_t port)
+{
+    size_t length = strlen(host);
+    /* names too long to remember are connected to, but not pooled */
+    int pooled = length < BSD_DNS_NAME_MAX;
+
+    pool_sweep(bsd_clock_ms());
+
+    if (pooled)
+    {
+        int fd = pool_checkout_idle(host, length, port);
+        if (fd >= 0)
+        {
+            return fd;
+        }
+    }
+
+    int fd = pool_connect(host, port);
+    if (fd >= 0 && pooled)
+    {
+        pool_track(fd, host, length, port);
+    }
+
+    return fd;
+}
+
+/*
+ * ::connpool_return()
+ */
+int connpool_return(int s, int reusable)
+{
+    uint32_t now = bsd_clock_ms();
+
+    pool_sweep(now);
+
+    unsigned long key = bsd_lock();
+    for (int i = 0; i < BSD_CONNPOOL_SIZE; ++i)
+    {
+        struct pool_entry *entry = &pool[i];
+        if (entry->state == POOL_BUSY && entry->fd == s)
+        {
+            /* a connection whose settings the borrower changed is not
+             * handed to the next borrower
+             */
+            if (reusable && now - entry->created < BSD_CONNPOOL_MAX_AGE_MS &&
+                pool_mode_clean(entry))
+            {
+                entry->returned = now;
+                entry->state = POOL_IDLE;
+                bsd_unlock(key);
+                return 0;
+            }
+            break;
+        }
+    }
+    bsd_unlock(key);
+
+    /* close() releases the slot, if any */
+    return close(s);
+}
+
+/*
+ * ::connpool_flush()
+ */
+void connpool_flush(void)
+{
+    for ( ; /* forever */ ; )
+    {
+        unsigned long key = bsd_lock();
+        int fd = pool_take_lru();
+        bsd_unlock(key);
+
+        if (fd < 0)
+        {
+            break;
+        }
+        close(fd);
+    }
+}
+
+/*
+ * bsd_connpool_evict()
+ */
+int bsd_connpool_evict(void)
+{
+    unsigned long key = bsd_lock();
+    int fd = pool_take_lru();
+    bsd_unlock(key);
+
+    if (fd < 0)
+    {
+        return 0;
+    }
+    close(fd);
+    return 1;
+}
+
+/*
+ * bsd_connpool_closed()
+ */
+void bsd_connpool_closed(int s)
+{
+    unsigned long key = bsd_lock();
+    for (int i = 0; i < BSD_CONNPOOL_SIZE; ++i)
+    {
+        if (pool[i].state != POOL_FREE && pool[i].fd == s)
+        {
+            pool[i].state = POOL_FREE;
+        }
+    }
+    bsd_unlock(key);
+}
@@ -0,0 +1,651 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_dns.c
+ * This file implements the host side resolver cache used by
+ * gethostbyname() and getaddrinfo(), and its optional persistence in the
+ * SimpleLink file system.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <netdb.h>
+#include <ctype.h>
+#include <string.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** entry is current */
+#define DNS_FRESH      0
+/** entry was loaded from the file system and has not been confirmed yet */
+#define DNS_STALE      1
+/** entry is stale and a background refresh of it is queued */
+#define DNS_REFRESHING 2
+
+/** One resolved name. */
+struct dns_entry
+{
+    uint32_t expires;      /**< bsd_clock_ms() value at which it expires */
+    uint32_t used;         /**< bsd_clock_ms() value of the last hit */
+    unsigned long addr;    /**< address, as returned by SimpleLink */
+    int16_t error;         /**< SimpleLink error of a failed lookup, or 0 */
+    uint16_t hash;         /**< hash of name, for a quick mismatch */
+    uint8_t family;        /**< SimpleLink address family, 0 if free */
+    uint8_t stale;         /**< DNS_FRESH, DNS_STALE or DNS_REFRESHING */
+    char name[BSD_DNS_NAME_MAX]; /**< host name, lower case */
+};
+
+/** A lookup the network processor is working on, which other threads
+ * asking for the same name wait for instead of issuing their own.
+ */
+struct dns_inflight
+{
+    const char *name;      /**< name being resolved, owned by the leader */
+    size_t length;         /**< length of name in bytes */
+    unsigned long addr;    /**< resolved address */
+    int result;            /**< SimpleLink result */
+    uint16_t hash;         /**< hash of name */
+    uint8_t family;        /**< SimpleLink address family */
+    uint8_t active;        /**< the leader has not finished yet */
+    uint8_t joinable;      /**< done has been created, others may wait */
+    uint8_t sem_created;   /**< done has been created */
+    uint8_t waiters;       /**< threads waiting for, or reading, the result */
+    OsiSyncObj_t done;     /**< passed from waiter to waiter on completion */
+};
+
+/** the resolver cache */
+static struct dns_entry dns_cache[BSD_DNS_CACHE_SIZE];
+
+/** lookups in progress */
+static struct dns_inflight dns_inflight[BSD_DNS_INFLIGHT_MAX];
+
+/** Hash a host name, ignoring case.
+ * @param name host name
+ * @param length length of name in bytes
+ * @return hash value
+ */
+static uint16_t dns_hash(const char *name, size_t length)
+{
+    uint32_t hash = 2166136261UL;
+
+    while (length--)
+    {
+        hash ^= (uint8_t)tolower((unsigned char)*name++);
+        hash *= 16777619UL;
+    }
+
+    return hash ^ (hash >> 16);
+}
+
+/** Compare a host name with the lower case name of a cache entry.
+ * @param entry_name name of the cache entry
+ * @param name host name, any case
+ * @param length length of name in bytes
+ * @return non-zero if the names are equal
+ */
+static int dns_name_equal(const char *entry_name, const char *name,
+                          size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (entry_name[i] != tolower((unsigned char)name[i]))
+        {
+            return 0;
+        }
+    }
+
+    return entry_name[length] == '\0';
+}
+
+/** Compare two host names of the same length, ignoring case.
+ * @param a first host name
+ * @param b second host name
+ * @param length length of both names in bytes
+ * @return non-zero if the names are equal
+ */
+static int dns_name_equal_nocase(const char *a, const char *b, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/** Find the cache entry for a name.  Must be called with bsd_lock() held.
+ * @param name host name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ * @param hash hash of name
+ * @return entry, or NULL if the name is not cached
+ */
+static struct dns_entry *dns_find(const char *name, size_t length,
+                                  uint8_t family, uint16_t hash)
+{
+    for (int i = 0; i < BSD_DNS_CACHE_SIZE; ++i)
+    {
+        struct dns_entry *entry = &dns_cache[i];
+        if (entry->family == family && entry->hash == hash &&
+            dns_name_equal(entry->name, name, length))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/** Record the outcome of a lookup, replacing an expired or the least
+ * recently used entry if the name is not cached yet.  A failed lookup does
+ * not replace a stale address, which keeps being used until a refresh
+ * succeeds.
+ * @param name host name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ * @param addr resolved address
+ * @param error SimpleLink error of a failed lookup, or 0
+ * @param ttl lifetime of the entry in milliseconds
+ * @param stale DNS_STALE for an address not confirmed by a lookup, else
+ *              DNS_FRESH
+ */
+static void dns_insert(const char *name, size_t length, uint8_t family,
+                       unsigned long addr, int error, uint32_t ttl,
+                       uint8_t stale)
+{
+    uint16_t hash = dns_hash(name, length);
+    uint32_t now = bsd_clock_ms();
+
+    unsigned long key = bsd_lock();
+    struct dns_entry *entry = dns_find(name, length, family, hash);
+    if (entry && entry->stale && error)
+    {
+        bsd_unlock(key);
+        return;
+    }
+    if (entry == NULL)
+    {
+        entry = &dns_cache[0];
+        for (int i = 0; i < BSD_DNS_CACHE_SIZE; ++i)
+        {
+            struct dns_entry *candidate = &dns_cache[i];
+            if (candidate->family == 0 ||
+                ((int32_t)(candidate->expires - now) <= 0 &&
+                 candidate->stale == DNS_FRESH))
+            {
+                entry = candidate;
+                break;
+            }
+            if ((int32_t)(candidate->used - entry->used) < 0)
+            {
+                entry = candidate;
+            }
+        }
+        for (size_t i = 0; i < length; ++i)
+        {
+            entry->name[i] = tolower((unsigned char)name[i]);
+        }
+        entry->name[length] = '\0';
+        entry->hash = hash;
+        entry->family = family;
+    }
+    entry->addr = addr;
+    entry->error = error;
+    entry->expires = now + ttl;
+    entry->used = now;
+    entry->stale = stale;
+    bsd_unlock(key);
+}
+
+/*
+ * ::dns_cache_flush()
+ */
+void dns_cache_flush(void)
+{
+    unsigned long key = bsd_lock();
+    for (int i = 0; i < BSD_DNS_CACHE_SIZE; ++i)
+    {
+        dns_cache[i].family = 0;
+    }
+    bsd_unlock(key);
+
+    bsd_mdns_flush();
+}
+
+/** Test if a failed lookup should be remembered.
+ * @param result SimpleLink error
+ * @return non-zero if asking again soon would fail the same way
+ */
+static int dns_negative(int result)
+{
+    switch (result)
+    {
+        default:
+            /* e.g. SL_POOL_IS_EMPTY, worth retrying right away */
+            return 0;
+        case SL_NET_APP_DNS_QUERY_NO_RESPONSE:
+        case SL_NET_APP_DNS_NO_SERVER:
+        case SL_NET_APP_DNS_QUERY_FAILED:
+        case SL_NET_APP_DNS_MALFORMED_PACKET:
+        case SL_NET_APP_DNS_MISMATCHED_RESPONSE:
+            return 1;
+    }
+}
+
+/** Wait for a lookup of the same name that another thread started.
+ * @param inflight lookup to wait for, its waiters count already includes
+ *                 the caller
+ * @param addr resolved address
+ * @return SimpleLink result of the lookup
+ */
+static int dns_wait(struct dns_inflight *inflight, unsigned long *addr)
+{
+    osi_SyncObjWait(&inflight->done, OSI_WAIT_FOREVER);
+
+    unsigned long key = bsd_lock();
+    int result = inflight->result;
+    *addr = inflight->addr;
+    int remaining = --inflight->waiters;
+    bsd_unlock(key);
+
+    if (remaining)
+    {
+        /* pass the baton to the next waiter */
+        osi_SyncObjSignal(&inflight->done);
+    }
+
+    return result;
+}
+
+/** Join a lookup of the same name in progress, or become the thread that
+ * performs it.  Must be called with bsd_lock() held.
+ * @param name host name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ * @param hash hash of name
+ * @param leader set to non-zero if the caller must perform the lookup
+ * @return lookup to wait for or to complete, NULL if the caller must
+ *         perform the lookup on its own
+ */
+static struct dns_inflight *dns_join(const char *name, size_t length,
+                                     uint8_t family, uint16_t hash,
+                                     int *leader)
+{
+    struct dns_inflight *free_slot = NULL;
+
+    for (int i = 0; i < BSD_DNS_INFLIGHT_MAX; ++i)
+    {
+        struct dns_inflight *inflight = &dns_inflight[i];
+        if (inflight->active)
+        {
+            if (inflight->joinable && inflight->family == family &&
+                inflight->hash == hash && inflight->length == length &&
+                inflight->waiters < UINT8_MAX &&
+                dns_name_equal_nocase(inflight->name, name, length))
+            {
+                ++inflight->waiters;
+                *leader = 0;
+                return inflight;
+            }
+        }
+        else if (inflight->waiters == 0 && free_slot == NULL)
+        {
+            free_slot = inflight;
+        }
+    }
+
+    *leader = 1;
+    if (free_slot)
+    {
+        free_slot->name = name;
+        free_slot->length = length;
+        free_slot->hash = hash;
+        free_slot->family = family;
+        free_slot->active = 1;
+        free_slot->joinable = 0;
+    }
+    return free_slot;
+}
+
+/** Perform a lookup the caller leads, or wait for the thread that leads it,
+ * and record the outcome in the cache.
+ * @param name host name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ * @param inflight lookup returned by dns_join(), or NULL
+ * @param leader non-zero if the caller must perform the lookup
+ * @param addr resolved address
+ * @return 0 upon success, otherwise the SimpleLink error code
+ */
+static int dns_resolve(const char *name, size_t length, uint8_t family,
+                       struct dns_inflight *inflight, int leader,
+                       unsigned long *addr)
+{
+    if (!leader)
+    {
+        return dns_wait(inflight, addr);
+    }
+
+    if (inflight)
+    {
+        /* let others with the same question wait for our answer */
+        if (inflight->sem_created ||
+            osi_SyncObjCreate(&inflight->done) == OSI_OK)
+        {
+            inflight->sem_created = 1;
+            unsigned long key = bsd_lock();
+            inflight->joinable = 1;
+            bsd_unlock(key);
+        }
+    }
+
+    int result = sl_NetAppDnsGetHostByName((int8_t*)name, length, addr,
+                                           family);
+
+    if (length < BSD_DNS_NAME_MAX)
+    {
+        if (result == 0)
+        {
+            dns_insert(name, length, family, *addr, 0, BSD_DNS_CACHE_TTL_MS,
+                       DNS_FRESH);
+        }
+        else if (dns_negative(result))
+        {
+            dns_insert(name, length, family, 0, result,
+                       BSD_DNS_NEGATIVE_TTL_MS, DNS_FRESH);
+        }
+    }
+
+    if (inflight)
+    {
+        unsigned long key = bsd_lock();
+        inflight->result = result;
+        inflight->addr = *addr;
+        inflight->active = 0;
+        int waiters = inflight->waiters;
+        bsd_unlock(key);
+
+        if (waiters)
+        {
+            osi_SyncObjSignal(&inflight->done);
+        }
+    }
+
+    return result;
+}
+
+/** Allow a stale entry to be queued for refresh again.
+ * @param name host name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ */
+static void dns_unqueue(const char *name, size_t length, uint8_t family)
+{
+    uint16_t hash = dns_hash(name, length);
+
+    unsigned long key = bsd_lock();
+    struct dns_entry *entry = dns_find(name, length, family, hash);
+    if (entry && entry->stale)
+    {
+        entry->stale = DNS_STALE;
+    }
+    bsd_unlock(key);
+}
+
+/*
+ * bsd_dns_lookup()
+ */
+int bsd_dns_lookup(const char *name, uint8_t family, unsigned long *addr)
+{
+    size_t length = strlen(name);
+    uint16_t hash = dns_hash(name, length);
+    struct dns_inflight *inflight = NULL;
+    int leader = 1;
+
+    if (length < BSD_DNS_NAME_MAX)
+    {
+        uint32_t now = bsd_clock_ms();
+
+        unsigned long key = bsd_lock();
+        struct dns_entry *entry = dns_find(name, length, family, hash);
+        if (entry && entry->stale)
+        {
+            /* answer optimistically and confirm the address off line */
+            entry->used = now;
+            *addr = entry->addr;
+            int refresh = entry->stale == DNS_STALE;
+            entry->stale = DNS_REFRESHING;
+            bsd_unlock(key);
+
+            if (refresh && bsd_refresh_async(bsd_dns_refresh, name, family) < 0)
+            {
+                dns_unqueue(name, length, family);
+            }
+            return 0;
+        }
+        if (entry && (int32_t)(entry->expires - now) > 0)
+        {
+            entry->used = now;
+            *addr = entry->addr;
+            int error = entry->error;
+            bsd_unlock(key);
+            return error;
+        }
+        inflight = dns_join(name, length, family, hash, &leader);
+        bsd_unlock(key);
+    }
+
+    return dns_resolve(name, length, family, inflight, leader, addr);
+}
+
+/*
+ * bsd_dns_refresh()
+ */
+void bsd_dns_refresh(const char *name, uint8_t family)
+{
+    size_t length = strlen(name);
+    uint16_t hash = dns_hash(name, length);
+    unsigned long addr;
+    int leader;
+
+    unsigned long key = bsd_lock();
+    struct dns_inflight *inflight = dns_join(name, length, family, hash,
+                                             &leader);
+    bsd_unlock(key);
+
+    if (dns_resolve(name, length, family, inflight, leader, &addr) != 0)
+    {
+        /* still stale, the next lookup tries again */
+        dns_unqueue(name, length, family);
+    }
+}
+
+#if defined(SL_INC_NVMEM_PKG)
+/** "BDNS", identifies a resolver cache file */
+#define DNS_FILE_MAGIC   0x534e4442UL
+/** layout version of the resolver cache file */
+#define DNS_FILE_VERSION 1
+
+/** Header of the resolver cache file. */
+struct dns_file_header
+{
+    uint32_t magic;        /**< DNS_FILE_MAGIC */
+    uint16_t version;      /**< DNS_FILE_VERSION */
+    uint16_t count;        /**< number of records that follow */
+};
+
+/** One name in the resolver cache file. */
+struct dns_file_record
+{
+    uint32_t addr;         /**< address, as returned by SimpleLink */
+    uint8_t family;        /**< SimpleLink address family */
+    uint8_t reserved[3];   /**< padding, zero */
+    char name[BSD_DNS_NAME_MAX]; /**< host name, lower case */
+};
+
+/** Largest size of the resolver cache file in bytes. */
+#define DNS_FILE_SIZE (sizeof(struct dns_file_header) + \
+                       (BSD_DNS_CACHE_SIZE * sizeof(struct dns_file_record)))
+
+/*
+ * ::dns_cache_save()
+ */
+int dns_cache_save(void)
+{
+    struct dns_file_header *header = malloc(DNS_FILE_SIZE);
+    if (header == NULL)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+    struct dns_file_record *record = (struct dns_file_record*)(header + 1);
+
+    header->magic = DNS_FILE_MAGIC;
+    header->version = DNS_FILE_VERSION;
+    header->count = 0;
+
+    unsigned long key = bsd_lock();
+    for (int i = 0; i < BSD_DNS_CACHE_SIZE; ++i)
+    {
+        struct dns_entry *entry = &dns_cache[i];
+        if (entry->family != 0 && entry->error == 0)
+        {
+            memset(record, 0, sizeof(struct dns_file_record));
+            record->addr = entry->addr;
+            record->family = entry->family;
+            strcpy(record->name, entry->name);
+            ++record;
+            ++header->count;
+        }
+    }
+    bsd_unlock(key);
+
+    uint32_t size = sizeof(struct dns_file_header) +
+                    (header->count * sizeof(struct dns_file_record));
+    _i32 handle;
+    _u32 token;
+    int result = -1;
+    SlFsFileInfo_t info;
+
+    if (sl_FsGetInfo((const _u8*)BSD_DNS_CACHE_FILE, 0, &info) == 0 &&
+        info.AllocatedLen < DNS_FILE_SIZE)
+    {
+        /* created before BSD_DNS_CACHE_SIZE grew, make room */
+        sl_FsDel((const _u8*)BSD_DNS_CACHE_FILE, 0);
+    }
+
+    if (sl_FsOpen((const _u8*)BSD_DNS_CACHE_FILE, FS_MODE_OPEN_WRITE,
+                  &token, &handle) < 0 &&
+        sl_FsOpen((const _u8*)BSD_DNS_CACHE_FILE,
+                  FS_MODE_OPEN_CREATE(DNS_FILE_SIZE,
+                                      _FS_FILE_OPEN_FLAG_COMMIT),
+                  &token, &handle) < 0)
+    {
+        errno = EIO;
+    }
+    else
+    {
+        if (sl_FsWrite(handle, 0, (_u8*)header, size) == (_i32)size)
+        {
+            result = 0;
+        }
+        else
+        {
+            errno = EIO;
+        }
+        sl_FsClose(handle, NULL, NULL, 0);
+    }
+
+    free(header);
+    return result;
+}
+
+/*
+ * ::dns_cache_load()
+ */
+int dns_cache_load(void)
+{
+    struct dns_file_header header;
+    struct dns_file_record record;
+    _i32 handle;
+    _u32 token;
+
+    if (sl_FsOpen((const _u8*)BSD_DNS_CACHE_FILE, FS_MODE_OPEN_READ,
+                  &token, &handle) < 0)
+    {
+        errno = ENOENT;
+        return -1;
+    }
+
+    int count = -1;
+    errno = EIO;
+    if (sl_FsRead(handle, 0, (_u8*)&header, sizeof(header)) ==
+            sizeof(header) &&
+        header.magic == DNS_FILE_MAGIC &&
+        header.version == DNS_FILE_VERSION)
+    {
+        _u32 offset = sizeof(header);
+        count = 0;
+        for (int i = 0; i < header.count && i < BSD_DNS_CACHE_SIZE; ++i)
+        {
+            if (sl_FsRead(handle, offset, (_u8*)&record, sizeof(record)) !=
+                sizeof(record))
+            {
+                break;
+            }
+            offset += sizeof(record);
+
+            const char *end = memchr(record.name, '\0', BSD_DNS_NAME_MAX);
+            size_t length = end ? (size_t)(end - record.name) : 0;
+            if (record.family == 0 || length == 0)
+            {
+                /* corrupt record */
+                continue;
+            }
+            /* a live answer that raced the load takes precedence */
+            unsigned long key = bsd_lock();
+            int cached = dns_find(record.name, length, record.family,
+                                  dns_hash(record.name, length)) != NULL;
+            bsd_unlock(key);
+            if (!cached)
+            {
+                dns_insert(record.name, length, record.family, record.addr,
+                           0, 0, DNS_STALE);
+                ++count;
+            }
+        }
+    }
+
+    sl_FsClose(handle, NULL, NULL, 0);
+    return count;
+}
+#endif
@@ -0,0 +1,277 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_dns_async.c
+ * This file implements asynchronous name resolution on a wrapper owned
+ * worker thread.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <netdb.h>
+#include <string.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** thread is not running */
+#define THREAD_STOPPED  0
+/** thread is being created */
+#define THREAD_STARTING 1
+/** thread is running */
+#define THREAD_RUNNING  2
+
+/** request is a getaddrinfo_async() call */
+#define REQUEST_GETADDRINFO 0
+/** request is a cache refresh */
+#define REQUEST_REFRESH     1
+
+/** A queued resolution request, the strings follow in the same allocation.
+ */
+struct dns_request
+{
+    struct dns_request *next;          /**< next request in the queue */
+    getaddrinfo_callback_t callback;   /**< completion callback */
+    bsd_refresh_t refresh;             /**< cache refresh to perform */
+    void *context;                     /**< context passed to callback */
+    struct addrinfo hints;             /**< copy of the hints */
+    uint8_t kind;                      /**< REQUEST_GETADDRINFO or
+                                        *   REQUEST_REFRESH */
+    uint8_t has_hints;                 /**< hints were given */
+    uint8_t family;                    /**< SimpleLink address family of a
+                                        *   refresh */
+    const char *nodename;              /**< host name, or NULL */
+    const char *servname;              /**< service name, or NULL */
+};
+
+/** state of the resolver thread */
+static volatile uint8_t thread_state = THREAD_STOPPED;
+
+/** signaled when a request has been queued */
+static OsiSyncObj_t work_sem;
+
+/** oldest queued request */
+static struct dns_request *queue_head = NULL;
+
+/** newest queued request */
+static struct dns_request *queue_tail = NULL;
+
+/** Entry point of the resolver thread.
+ * @param arg unused
+ */
+static void resolver_thread(void *arg)
+{
+    for ( ; /* forever */ ; )
+    {
+        osi_SyncObjWait(&work_sem, OSI_WAIT_FOREVER);
+
+        for ( ; /* forever */ ; )
+        {
+            unsigned long key = bsd_lock();
+            struct dns_request *request = queue_head;
+            if (request)
+            {
+                queue_head = request->next;
+                if (queue_head == NULL)
+                {
+                    queue_tail = NULL;
+                }
+            }
+            bsd_unlock(key);
+
+            if (request == NULL)
+            {
+                break;
+            }
+
+            if (request->kind == REQUEST_REFRESH)
+            {
+                request->refresh(request->nodename, request->family);
+            }
+            else
+            {
+                struct addrinfo *res = NULL;
+                int error = getaddrinfo(request->nodename, request->servname,
+                                        request->has_hints ?
+                                            &request->hints : NULL,
+                                        &res);
+                request->callback(error, error ? NULL : res, request->context);
+            }
+            free(request);
+        }
+    }
+}
+
+/** Start the resolver thread if it is not already running.
+ * @return 0 upon success, otherwise -1
+ */
+static int thread_start(void)
+{
+    unsigned long key = bsd_lock();
+    if (thread_state != THREAD_STOPPED)
+    {
+        bsd_unlock(key);
+        while (thread_state == THREAD_STARTING)
+        {
+            osi_Sleep(1);
+        }
+        /* the thread that won the race may have failed to create it */
+        return thread_state == THREAD_RUNNING ? 0 : -1;
+    }
+    thread_state = THREAD_STARTING;
+    bsd_unlock(key);
+
+    if (osi_SyncObjCreate(&work_sem) != OSI_OK)
+    {
+        thread_state = THREAD_STOPPED;
+        return -1;
+    }
+    if (osi_TaskCreate(resolver_thread, (const signed char*)"bsd_dns",
+                       BSD_DNS_ASYNC_STACK_SIZE, NULL,
+                       BSD_DNS_ASYNC_PRIORITY, NULL) != OSI_OK)
+    {
+        osi_SyncObjDelete(&work_sem);
+        thread_state = THREAD_STOPPED;
+        return -1;
+    }
+
+    thread_state = THREAD_RUNNING;
+    return 0;
+}
+
+/** Copy a string into the tail of a request allocation.
+ * @param dst destination
+ * @param src string to copy, may be NULL
+ * @return copy, or NULL if src is NULL
+ */
+static const char *request_copy(char *dst, const char *src)
+{
+    if (src == NULL)
+    {
+        return NULL;
+    }
+    return strcpy(dst, src);
+}
+
+/** Append a request to the queue and wake up the resolver thread.
+ * @param request request to queue
+ */
+static void request_queue(struct dns_request *request)
+{
+    unsigned long key = bsd_lock();
+    if (queue_tail)
+    {
+        queue_tail->next = request;
+    }
+    else
+    {
+        queue_head = request;
+    }
+    queue_tail = request;
+    bsd_unlock(key);
+
+    osi_SyncObjSignal(&work_sem);
+}
+
+/*
+ * ::getaddrinfo_async()
+ */
+int getaddrinfo_async(const char *nodename, const char *servname,
+                      const struct addrinfo *hints,
+                      getaddrinfo_callback_t callback, void *context)
+{
+    size_t node_len = nodename ? strlen(nodename) + 1 : 0;
+    size_t serv_len = servname ? strlen(servname) + 1 : 0;
+
+    if (callback == NULL)
+    {
+        /* the result would have nowhere to go */
+        return EAI_FAIL;
+    }
+
+    if (thread_start() < 0)
+    {
+        return EAI_AGAIN;
+    }
+
+    struct dns_request *request = malloc(sizeof(struct dns_request) +
+                                         node_len + serv_len);
+    if (request == NULL)
+    {
+        return EAI_MEMORY;
+    }
+
+    char *strings = (char*)(request + 1);
+    request->next = NULL;
+    request->callback = callback;
+    request->refresh = NULL;
+    request->context = context;
+    request->kind = REQUEST_GETADDRINFO;
+    request->has_hints = hints != NULL;
+    request->family = 0;
+    if (hints)
+    {
+        request->hints = *hints;
+    }
+    request->nodename = request_copy(strings, nodename);
+    request->servname = request_copy(strings + node_len, servname);
+
+    request_queue(request);
+    return 0;
+}
+
+/*
+ * bsd_refresh_async()
+ */
+int bsd_refresh_async(bsd_refresh_t refresh, const char *name, uint8_t family)
+{
+    if (thread_start() < 0)
+    {
+        return -1;
+    }
+
+    struct dns_request *request = malloc(sizeof(struct dns_request) +
+                                         strlen(name) + 1);
+    if (request == NULL)
+    {
+        return -1;
+    }
+
+    request->next = NULL;
+    request->callback = NULL;
+    request->refresh = refresh;
+    request->context = NULL;
+    request->kind = REQUEST_REFRESH;
+    request->has_hints = 0;
+    request->family = family;
+    request->nodename = request_copy((char*)(request + 1), name);
+    request->servname = NULL;
+
+    request_queue(request);
+    return 0;
+}
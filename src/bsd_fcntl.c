@@ -0,0 +1,78 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_fcntl.c
+ * This file implements POSIX fcntl() for sockets.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#if !defined(__TI_COMPILER_VERSION__)
+#include <fcntl.h>
+#endif
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/*
+ * ::fcntl()
+ *
+ * Defined directly rather than as newlib's _fcntl_r(), which newlib's own
+ * fcntl() only calls when the target defines HAVE_FCNTL, and arm-none-eabi
+ * does not.
+ */
+int fcntl(int s, int cmd, ...)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    switch (cmd)
+    {
+        default:
+            errno = EINVAL;
+            return -1;
+        case F_GETFL:
+            return O_RDWR | (sock->nonblock ? O_NONBLOCK : 0);
+        case F_SETFL:
+        {
+            va_list ap;
+            va_start(ap, cmd);
+            int arg = va_arg(ap, int);
+            va_end(ap);
+            return bsd_set_nonblocking(s, arg & O_NONBLOCK);
+        }
+    }
+}
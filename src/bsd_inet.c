@@ -0,0 +1,338 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_inet.c
+ * This file implements the IPv4 address text conversions.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <string.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** Format an IPv4 address in dotted decimal notation.
+ * @param addr address, network byte order
+ * @param dst destination, at least INET_ADDRSTRLEN bytes
+ * @return dst
+ */
+static char *format4(uint32_t addr, char *dst)
+{
+    const uint8_t *octet = (const uint8_t*)&addr;
+    char *p = dst;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        unsigned value = octet[i];
+        unsigned hundreds = value / 100;
+        unsigned tens = (value / 10) % 10;
+
+        *p = '0' + hundreds;
+        p += hundreds != 0;
+        *p = '0' + tens;
+        p += (hundreds | tens) != 0;
+        *p++ = '0' + value % 10;
+        *p++ = '.';
+    }
+    p[-1] = '\0';
+
+    return dst;
+}
+
+/*
+ * bsd_inet_parse4()
+ */
+int bsd_inet_parse4(const char *src, uint32_t *addr)
+{
+    uint32_t result = 0;
+
+    for (int part = 0; part < 4; ++part)
+    {
+        unsigned value = 0;
+        int digits = 0;
+
+        while (*src >= '0' && *src <= '9')
+        {
+            if (digits && value == 0)
+            {
+                /* a leading zero would read as octal to inet_aton() */
+                return 0;
+            }
+            value = value * 10 + (*src++ - '0');
+            if (++digits > 3 || value > 255)
+            {
+                return 0;
+            }
+        }
+        if (digits == 0 || *src != (part < 3 ? '.' : '\0'))
+        {
+            return 0;
+        }
+        ++src;
+        result = (result << 8) | value;
+    }
+
+    *addr = htonl(result);
+    return 1;
+}
+
+/*
+ * ::inet_pton()
+ */
+int inet_pton(int af, const char *src, void *dst)
+{
+    uint32_t addr;
+
+    if (af != AF_INET)
+    {
+        errno = EAFNOSUPPORT;
+        return -1;
+    }
+
+    if (!bsd_inet_parse4(src, &addr))
+    {
+        return 0;
+    }
+
+    memcpy(dst, &addr, sizeof(addr));
+    return 1;
+}
+
+/*
+ * ::inet_ntop()
+ */
+const char *inet_ntop(int af, const void *src, char *dst, socklen_t size)
+{
+    uint32_t addr;
+
+    if (af != AF_INET)
+    {
+        errno = EAFNOSUPPORT;
+        return NULL;
+    }
+
+    memcpy(&addr, src, sizeof(addr));
+
+    if (size >= INET_ADDRSTRLEN)
+    {
+        return format4(addr, dst);
+    }
+
+    /* format on the stack, the result may still fit */
+    char buf[INET_ADDRSTRLEN];
+    size_t length = strlen(format4(addr, buf)) + 1;
+    if (length > size)
+    {
+        errno = ENOSPC;
+        return NULL;
+    }
+
+    memcpy(dst, buf, length);
+    return dst;
+}
+
+/*
+ * ::inet_aton()
+ */
+int inet_aton(const char *cp, struct in_addr *inp)
+{
+    uint32_t parts[4];
+    int count = 0;
+
+    for ( ; /* forever */ ; )
+    {
+        /* each part is decimal, 0 prefixed octal, or 0x prefixed hex */
+        uint32_t value = 0;
+        unsigned base = 10;
+        int digits = 0;
+
+        if (*cp == '0')
+        {
+            base = 8;
+            digits = 1;
+            ++cp;
+            if (*cp == 'x' || *cp == 'X')
+            {
+                base = 16;
+                digits = 0;
+                ++cp;
+            }
+        }
+
+        for ( ; /* forever */ ; ++cp, ++digits)
+        {
+            unsigned c = (unsigned char)*cp;
+            unsigned digit;
+
+            if (c >= '0' && c <= '9')
+            {
+                digit = c - '0';
+            }
+            else if (base == 16 && (c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            {
+                digit = (c | 0x20) - 'a' + 10;
+            }
+            else
+            {
+                break;
+            }
+            if (digit >= base || value > (UINT32_MAX - digit) / base)
+            {
+                return 0;
+            }
+            value = value * base + digit;
+        }
+
+        if (digits == 0)
+        {
+            return 0;
+        }
+        parts[count++] = value;
+        if (*cp != '.')
+        {
+            break;
+        }
+        if (count == 4)
+        {
+            return 0;
+        }
+        ++cp;
+    }
+
+    if (*cp != '\0' && *cp != ' ' && *cp != '\t' && *cp != '\n')
+    {
+        return 0;
+    }
+
+    /* a.b.c.d, a.b.c with c 16 bits, a.b with b 24 bits, or a 32-bit a */
+    uint32_t addr = parts[count - 1];
+    uint32_t last_max = UINT32_MAX >> (8 * (count - 1));
+    if (addr > last_max)
+    {
+        return 0;
+    }
+    for (int i = 0; i < count - 1; ++i)
+    {
+        if (parts[i] > 0xFF)
+        {
+            return 0;
+        }
+        addr |= parts[i] << (24 - 8 * i);
+    }
+
+    if (inp)
+    {
+        inp->s_addr = htonl(addr);
+    }
+    return 1;
+}
+
+/*
+ * ::inet_addr()
+ */
+in_addr_t inet_addr(const char *cp)
+{
+    struct in_addr addr;
+
+    return inet_aton(cp, &addr) ? addr.s_addr : INADDR_NONE;
+}
+
+/*
+ * ::inet_ntoa_r()
+ */
+char *inet_ntoa_r(struct in_addr in, char *buf, socklen_t size)
+{
+    return (char*)inet_ntop(AF_INET, &in, buf, size);
+}
+
+/*
+ * ::inet_ntoa()
+ */
+char *inet_ntoa(struct in_addr in)
+{
+    static char buf[INET_ADDRSTRLEN];
+
+    return format4(in.s_addr, buf);
+}
+
+#if defined(__GNUC__)
+/** 32-bit word allowed to alias the 16-bit fields it is loaded from */
+typedef uint32_t __attribute__((may_alias)) alias_word_t;
+#else
+/** 32-bit word allowed to alias the 16-bit fields it is loaded from */
+typedef uint32_t alias_word_t;
+#endif
+
+/*
+ * ::htons_array()
+ */
+void htons_array(uint16_t *data, size_t count)
+{
+#if defined(BSD_BSWAP16)
+    if (count && ((uintptr_t)data & 2))
+    {
+        *data = BSD_BSWAP16(*data);
+        ++data;
+        --count;
+    }
+
+    /* data is word aligned now, swap the bytes of both halves of a word at
+     * once
+     */
+    for ( ; count >= 2; count -= 2, data += 2)
+    {
+        alias_word_t *word = (alias_word_t*)data;
+        *word = ((*word & 0x00FF00FF) << 8) | ((*word >> 8) & 0x00FF00FF);
+    }
+
+    if (count)
+    {
+        *data = BSD_BSWAP16(*data);
+    }
+#else
+    for (size_t i = 0; i < count; ++i)
+    {
+        data[i] = htons(data[i]);
+    }
+#endif
+}
+
+/*
+ * ::htonl_array()
+ */
+void htonl_array(uint32_t *data, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        data[i] = htonl(data[i]);
+    }
+}
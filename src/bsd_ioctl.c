@@ -0,0 +1,123 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_ioctl.c
+ * This file implements POSIX ioctl() for sockets.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <stdarg.h>
+#include <errno.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** Count the bytes a socket can receive without blocking.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @return number of bytes, otherwise -1 with errno set
+ */
+static int fionread(int s, struct bsd_socket *sock)
+{
+    if (sock->rx_demux)
+    {
+        return bsd_async_recv_pending(sock);
+    }
+
+    if (sock->rx_buf == NULL)
+    {
+        /* the network processor does not tell how much is waiting */
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+
+    if (sock->rx_count)
+    {
+        return sock->rx_count;
+    }
+
+    SlTimeval_t tv;
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+
+    int result = bsd_wait_ready(s, 0, &tv);
+    if (result <= 0)
+    {
+        return result;
+    }
+
+    /* pull it over, the read will not block now */
+    result = bsd_rx_fill(s, sock);
+    return result < 0 ? -1 : sock->rx_count;
+}
+
+/*
+ * ::ioctl()
+ */
+int ioctl(int s, unsigned long request, ...)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    va_list ap;
+    va_start(ap, request);
+    int *arg = va_arg(ap, int *);
+    va_end(ap);
+
+    if (arg == NULL)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    switch (request)
+    {
+        default:
+            errno = EINVAL;
+            return -1;
+        case FIONREAD:
+        {
+            int result = fionread(s, sock);
+            if (result < 0)
+            {
+                return -1;
+            }
+            *arg = result;
+            return 0;
+        }
+        case FIONBIO:
+            return bsd_set_nonblocking(s, *arg);
+    }
+}
@@ -0,0 +1,352 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_mdns.c
+ * This file implements DNS-SD service instance lookup with a host side
+ * cache refreshed in the background.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <ctype.h>
+#include <string.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** One resolved service instance. */
+struct mdns_entry
+{
+    uint32_t expires;      /**< bsd_clock_ms() value at which it expires */
+    uint32_t refresh;      /**< bsd_clock_ms() value after which a hit queues
+                            *   a background refresh */
+    uint32_t used;         /**< bsd_clock_ms() value of the last hit */
+    uint32_t addr;         /**< address, network byte order */
+    uint16_t port;         /**< port, network byte order */
+    uint16_t txt_len;      /**< length of the TXT record data in txt */
+    int16_t error;         /**< SimpleLink error of a failed lookup, or 0 */
+    uint8_t family;        /**< SimpleLink address family, 0 if free */
+    uint8_t refreshing;    /**< a background refresh is queued */
+    char name[BSD_DNS_NAME_MAX]; /**< service instance name, lower case */
+    char txt[BSD_MDNS_TXT_MAX];  /**< TXT record data */
+};
+
+/** the service cache */
+static struct mdns_entry mdns_cache[BSD_MDNS_CACHE_SIZE];
+
+/** Compare a service instance name with the lower case name of a cache
+ * entry.
+ * @param entry_name name of the cache entry
+ * @param name service instance name, any case
+ * @param length length of name in bytes
+ * @return non-zero if the names are equal
+ */
+static int mdns_name_equal(const char *entry_name, const char *name,
+                           size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (entry_name[i] != tolower((unsigned char)name[i]))
+        {
+            return 0;
+        }
+    }
+
+    return entry_name[length] == '\0';
+}
+
+/** Find the cache entry for a service instance.  Must be called with
+ * bsd_lock() held.
+ * @param name service instance name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ * @return entry, or NULL if the instance is not cached
+ */
+static struct mdns_entry *mdns_find(const char *name, size_t length,
+                                    uint8_t family)
+{
+    for (int i = 0; i < BSD_MDNS_CACHE_SIZE; ++i)
+    {
+        struct mdns_entry *entry = &mdns_cache[i];
+        if (entry->family == family &&
+            mdns_name_equal(entry->name, name, length))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/** Record the outcome of a lookup, replacing an expired or the least
+ * recently used entry if the instance is not cached yet.  A failed lookup
+ * does not replace an answer that has not expired yet, so a failed refresh
+ * leaves the last answer in place until its lifetime is over.
+ * @param name service instance name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ * @param answer outcome of the lookup
+ * @param ttl lifetime of the entry in milliseconds
+ */
+static void mdns_insert(const char *name, size_t length, uint8_t family,
+                        const struct mdns_entry *answer, uint32_t ttl)
+{
+    uint32_t now = bsd_clock_ms();
+
+    unsigned long key = bsd_lock();
+    struct mdns_entry *entry = mdns_find(name, length, family);
+    if (entry && answer->error && entry->error == 0 &&
+        (int32_t)(entry->expires - now) > 0)
+    {
+        entry->refreshing = 0;
+        bsd_unlock(key);
+        return;
+    }
+    if (entry == NULL)
+    {
+        entry = &mdns_cache[0];
+        for (int i = 0; i < BSD_MDNS_CACHE_SIZE; ++i)
+        {
+            struct mdns_entry *candidate = &mdns_cache[i];
+            if (candidate->family == 0 ||
+                (int32_t)(candidate->expires - now) <= 0)
+            {
+                entry = candidate;
+                break;
+            }
+            if ((int32_t)(candidate->used - entry->used) < 0)
+            {
+                entry = candidate;
+            }
+        }
+        for (size_t i = 0; i < length; ++i)
+        {
+            entry->name[i] = tolower((unsigned char)name[i]);
+        }
+        entry->name[length] = '\0';
+        entry->family = family;
+    }
+    entry->addr = answer->addr;
+    entry->port = answer->port;
+    entry->error = answer->error;
+    entry->txt_len = answer->txt_len;
+    memcpy(entry->txt, answer->txt, answer->txt_len);
+    entry->expires = now + ttl;
+    /* like an RFC 6762 querier, ask again at 80% of the lifetime */
+    entry->refresh = now + (ttl - (ttl / 5));
+    entry->used = now;
+    entry->refreshing = 0;
+    bsd_unlock(key);
+}
+
+/** Translate a SimpleLink DNS-SD error into a getaddrinfo() error.
+ * @param result SimpleLink error
+ * @return EAI_* error code
+ */
+static int mdns_error(int result)
+{
+    switch (result)
+    {
+        default:
+        case SL_POOL_IS_EMPTY:
+            return EAI_AGAIN;
+        case SL_NET_APP_DNS_QUERY_NO_RESPONSE:
+        case SL_NET_APP_DNS_NO_SERVER:
+        case SL_NET_APP_DNS_QUERY_FAILED:
+        case SL_NET_APP_DNS_MALFORMED_PACKET:
+        case SL_NET_APP_DNS_MISMATCHED_RESPONSE:
+            return EAI_FAIL;
+    }
+}
+
+/** Look a service instance up with the network processor and record the
+ * outcome in the cache.
+ * @param name service instance name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ * @param answer outcome of the lookup
+ */
+static void mdns_query(const char *name, size_t length, uint8_t family,
+                       struct mdns_entry *answer)
+{
+    /* room for an IPv6 address, should the network processor return one */
+    _u32 addr[4];
+    _u32 port = 0;
+    _u16 txt_len = BSD_MDNS_TXT_MAX;
+
+    int result = sl_NetAppDnsGetHostByService((_i8*)name, length, family,
+                                              addr, &port, &txt_len,
+                                              (_i8*)answer->txt);
+
+    answer->error = result;
+    if (result == 0)
+    {
+        answer->addr = htonl(addr[0]);
+        answer->port = htons(port);
+        answer->txt_len = txt_len < BSD_MDNS_TXT_MAX ?
+                          txt_len : BSD_MDNS_TXT_MAX;
+    }
+    else
+    {
+        answer->addr = 0;
+        answer->port = 0;
+        answer->txt_len = 0;
+    }
+
+    if (length < BSD_DNS_NAME_MAX)
+    {
+        if (result == 0)
+        {
+            mdns_insert(name, length, family, answer, BSD_MDNS_CACHE_TTL_MS);
+        }
+        else if (mdns_error(result) == EAI_FAIL)
+        {
+            mdns_insert(name, length, family, answer,
+                        BSD_DNS_NEGATIVE_TTL_MS);
+        }
+    }
+}
+
+/** Allow a cache entry to be queued for refresh again.
+ * @param name service instance name
+ * @param length length of name in bytes
+ * @param family SimpleLink address family
+ */
+static void mdns_unqueue(const char *name, size_t length, uint8_t family)
+{
+    unsigned long key = bsd_lock();
+    struct mdns_entry *entry = mdns_find(name, length, family);
+    if (entry)
+    {
+        entry->refreshing = 0;
+    }
+    bsd_unlock(key);
+}
+
+/*
+ * bsd_mdns_refresh()
+ */
+void bsd_mdns_refresh(const char *name, uint8_t family)
+{
+    size_t length = strlen(name);
+    struct mdns_entry answer;
+
+    mdns_query(name, length, family, &answer);
+    if (answer.error)
+    {
+        /* not remembered, the next hit tries again */
+        mdns_unqueue(name, length, family);
+    }
+}
+
+/*
+ * bsd_mdns_flush()
+ */
+void bsd_mdns_flush(void)
+{
+    unsigned long key = bsd_lock();
+    for (int i = 0; i < BSD_MDNS_CACHE_SIZE; ++i)
+    {
+        mdns_cache[i].family = 0;
+    }
+    bsd_unlock(key);
+}
+
+/*
+ * ::getaddrinfo_service()
+ */
+int getaddrinfo_service(const char *service, const struct addrinfo *hints,
+                        struct addrinfo **res, char *txt, size_t *txtlen)
+{
+    if (hints && hints->ai_family != AF_UNSPEC && hints->ai_family != AF_INET)
+    {
+        /* only IPv4 is supported */
+        return EAI_FAMILY;
+    }
+
+    size_t length = service ? strlen(service) : 0;
+    if (length == 0 || length > UINT8_MAX)
+    {
+        return EAI_NONAME;
+    }
+
+    struct mdns_entry answer;
+    int cached = 0;
+
+    if (length < BSD_DNS_NAME_MAX)
+    {
+        uint32_t now = bsd_clock_ms();
+        int refresh = 0;
+
+        unsigned long key = bsd_lock();
+        struct mdns_entry *entry = mdns_find(service, length, SL_AF_INET);
+        if (entry && (int32_t)(entry->expires - now) > 0)
+        {
+            entry->used = now;
+            answer = *entry;
+            cached = 1;
+            if (entry->error == 0 && !entry->refreshing &&
+                (int32_t)(entry->refresh - now) <= 0)
+            {
+                entry->refreshing = 1;
+                refresh = 1;
+            }
+        }
+        bsd_unlock(key);
+
+        if (refresh &&
+            bsd_refresh_async(bsd_mdns_refresh, service, SL_AF_INET) < 0)
+        {
+            mdns_unqueue(service, length, SL_AF_INET);
+        }
+    }
+
+    if (!cached)
+    {
+        mdns_query(service, length, SL_AF_INET, &answer);
+    }
+
+    if (answer.error)
+    {
+        return mdns_error(answer.error);
+    }
+
+    if (txtlen)
+    {
+        if (txt)
+        {
+            memcpy(txt, answer.txt,
+                   answer.txt_len < *txtlen ? answer.txt_len : *txtlen);
+        }
+        *txtlen = answer.txt_len;
+    }
+
+    return bsd_addrinfo_build(service, answer.addr, answer.port, hints, res);
+}
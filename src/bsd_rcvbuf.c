@@ -0,0 +1,234 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_rcvbuf.c
+ * This file implements receive window auto-tuning for SO_RCVBUFAUTO.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <errno.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** Set the network processor receive window of a socket.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @param window new window size in bytes
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+static int rcvbuf_set(int s, struct bsd_socket *sock, uint32_t window)
+{
+    SlSockWinsize_t size;
+    size.WinSize = window;
+
+    int result = sl_SetSockOpt(s, SL_SOL_SOCKET, SL_SO_RCVBUF, &size,
+                               sizeof(size));
+    if (result < 0)
+    {
+        errno = result == SL_POOL_IS_EMPTY ? ENOMEM : EINVAL;
+        return -1;
+    }
+
+    unsigned long key = bsd_lock();
+    sock->rcvbuf = window;
+    sock->opts |= BSD_OPT_RCVBUF;
+    bsd_unlock(key);
+    return 0;
+}
+
+/*
+ * bsd_rcvbuf_auto()
+ */
+int bsd_rcvbuf_auto(int s, int enable)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (!enable)
+    {
+        /* keep whatever window was last chosen */
+        unsigned long key = bsd_lock();
+        sock->opts &= ~BSD_OPT_RCVBUFAUTO;
+        bsd_unlock(key);
+        return 0;
+    }
+
+    if (sock->type != SOCK_STREAM)
+    {
+        /* the network processor only has a receive window for TCP */
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (sock->opts & BSD_OPT_RCVBUFAUTO)
+    {
+        return 0;
+    }
+
+    if (rcvbuf_set(s, sock, BSD_RCVBUF_AUTO_MIN) < 0)
+    {
+        return -1;
+    }
+
+    /* the select thread shrinks the window of a connection gone quiet */
+    if (bsd_select_start() < 0)
+    {
+        return -1;
+    }
+
+    unsigned long key = bsd_lock();
+    sock->rx_epoch = bsd_clock_ms();
+    sock->rx_bytes = 0;
+    sock->rx_reads = 0;
+    sock->rx_short = 0;
+    sock->opts |= BSD_OPT_RCVBUFAUTO;
+    bsd_unlock(key);
+    return 0;
+}
+
+/** Adjust the receive window of a socket once per sample period, from the
+ * reads accounted since the last adjustment.  Only one thread evaluates a
+ * given period.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @return milliseconds until the next evaluation is due
+ */
+static uint32_t rcvbuf_evaluate(int s, struct bsd_socket *sock)
+{
+    unsigned long key = bsd_lock();
+    uint32_t now = bsd_clock_ms();
+    uint32_t elapsed = now - sock->rx_epoch;
+    if (elapsed < BSD_RCVBUF_AUTO_PERIOD_MS)
+    {
+        bsd_unlock(key);
+        return BSD_RCVBUF_AUTO_PERIOD_MS - elapsed;
+    }
+
+    /* normalize to the bytes received in one sample period */
+    uint32_t rate = (uint64_t)sock->rx_bytes * BSD_RCVBUF_AUTO_PERIOD_MS /
+                    elapsed;
+    int drained = sock->rx_short * 2 >= sock->rx_reads;
+    uint32_t window = sock->rcvbuf;
+
+    sock->rx_epoch = now;
+    sock->rx_bytes = 0;
+    sock->rx_reads = 0;
+    sock->rx_short = 0;
+    bsd_unlock(key);
+
+    if (rate >= window * 2 && drained)
+    {
+        /* bulk transfer with a consumer that keeps up, the window is the
+         * limit
+         */
+        window *= 2;
+    }
+    else if (rate < window / 4)
+    {
+        /* mostly idle, give network processor buffers back */
+        window /= 2;
+    }
+    /* else the window is about right, or the consumer is the bottleneck
+     * and a larger window would only hold more data in the network
+     * processor
+     */
+
+    if (window < BSD_RCVBUF_AUTO_MIN)
+    {
+        window = BSD_RCVBUF_AUTO_MIN;
+    }
+    else if (window > BSD_RCVBUF_AUTO_MAX)
+    {
+        window = BSD_RCVBUF_AUTO_MAX;
+    }
+
+    if (window != sock->rcvbuf)
+    {
+        int grow = window > sock->rcvbuf;
+        /* on failure keep the old window and try again next period */
+        if (rcvbuf_set(s, sock, window) == 0 && grow)
+        {
+            /* have the select thread shrink it again should the
+             * connection go quiet
+             */
+            bsd_select_kick();
+        }
+    }
+
+    return BSD_RCVBUF_AUTO_PERIOD_MS;
+}
+
+/*
+ * bsd_rcvbuf_tune()
+ */
+void bsd_rcvbuf_tune(int s, struct bsd_socket *sock, int result,
+                     size_t requested)
+{
+    unsigned long key = bsd_lock();
+    sock->rx_bytes += result;
+    if (sock->rx_reads != UINT16_MAX)
+    {
+        ++sock->rx_reads;
+        if ((size_t)result < requested)
+        {
+            /* the consumer drained everything the network processor had */
+            ++sock->rx_short;
+        }
+    }
+    bsd_unlock(key);
+
+    rcvbuf_evaluate(s, sock);
+}
+
+/*
+ * bsd_rcvbuf_idle()
+ */
+uint32_t bsd_rcvbuf_idle(void)
+{
+    uint32_t next = OSI_WAIT_FOREVER;
+
+    for (int s = 0; s < SL_MAX_SOCKETS; ++s)
+    {
+        struct bsd_socket *sock = &bsd_sockets[s];
+        if (!(sock->opts & BSD_OPT_RCVBUFAUTO) || sock->closing ||
+            sock->rcvbuf <= BSD_RCVBUF_AUTO_MIN)
+        {
+            /* nothing left to give back */
+            continue;
+        }
+
+        uint32_t due = rcvbuf_evaluate(s, sock);
+        if (due < next)
+        {
+            next = due;
+        }
+    }
+
+    return next;
+}
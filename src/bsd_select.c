@@ -40,6 +40,529 @@
 #include <errno.h>
 
 #include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** thread is not running */
+#define THREAD_STOPPED  0
+/** thread is being created */
+#define THREAD_STARTING 1
+/** thread is running */
+#define THREAD_RUNNING  2
+
+/** A thread blocked in bsd_select() until the select thread answers it.
+ */
+struct select_waiter
+{
+    struct select_waiter *next; /**< next waiter in the list */
+    SlFdSet_t *readfds;   /**< caller's read set, receives the result */
+    SlFdSet_t *writefds;  /**< caller's write set, receives the result */
+    SlFdSet_t *exceptfds; /**< caller's error set, receives the result */
+    SlFdSet_t *host_wait; /**< SO_RXDEMUX sockets to watch, may be NULL */
+    SlFdSet_t *host_ready;/**< receives the host_wait sockets now ready */
+    volatile uint8_t *intr; /**< answer as timed out once set, may be NULL */
+    SlFdSet_t rd;         /**< requested read set */
+    SlFdSet_t wr;         /**< requested write set */
+    SlFdSet_t ex;         /**< requested error set */
+    uint32_t deadline;    /**< bsd_clock_ms() at which to time out */
+    int nfds;             /**< highest descriptor in the sets plus 1 */
+    int16_t result;       /**< sl_Select() style result */
+    uint8_t timed;        /**< deadline is valid */
+    uint8_t polled;       /**< sets were part of an sl_Select() */
+    OsiSyncObj_t sem;     /**< signaled once the waiter is answered */
+};
+
+/** state of the select thread */
+static volatile uint8_t thread_state = THREAD_STOPPED;
+
+/** the select thread is blocked in sl_Select() */
+static volatile uint8_t in_select = 0;
+
+/** a wakeup datagram is on its way for the current sl_Select() */
+static volatile uint8_t wake_sent = 0;
+
+/** loopback socket that interrupts sl_Select(), -1 if not available */
+static int wake_fd = -1;
+
+/** address wake_fd is bound to */
+static SlSockAddrIn_t wake_addr;
+
+/** threads waiting for an answer from the select thread */
+static struct select_waiter *waiters = NULL;
+
+/** signaled when there is work for an idle select thread */
+static OsiSyncObj_t work_sem;
+
+/** Open the loopback socket used to interrupt sl_Select().  Without it the
+ * select thread falls back to blocking for at most BSD_SELECT_POLL_MS.
+ */
+static void wake_open(void)
+{
+    int fd = sl_Socket(SL_AF_INET, SL_SOCK_DGRAM, 0);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    wake_addr.sin_family = SL_AF_INET;
+    wake_addr.sin_port = sl_Htons(BSD_SELECT_WAKE_PORT);
+    wake_addr.sin_addr.s_addr = sl_Htonl(0x7F000001);
+    if (sl_Bind(fd, (SlSockAddr_t*)&wake_addr, sizeof(wake_addr)) < 0)
+    {
+        sl_Close(fd);
+        return;
+    }
+    wake_fd = fd;
+}
+
+/** Merge the sets of a waiter into the sets of the next sl_Select().
+ * @param w waiter
+ * @param rd read set to add to
+ * @param wr write set to add to
+ * @param ex error set to add to
+ * @return highest descriptor of the waiter plus 1, 0 if it has none
+ */
+static int waiter_merge(struct select_waiter *w, SlFdSet_t *rd,
+                        SlFdSet_t *wr, SlFdSet_t *ex)
+{
+    int nfds = 0;
+    for (int i = 0; i < w->nfds; ++i)
+    {
+        if (SL_FD_ISSET(i, &w->rd))
+        {
+            SL_FD_SET(i, rd);
+            nfds = i + 1;
+        }
+        if (SL_FD_ISSET(i, &w->wr))
+        {
+            SL_FD_SET(i, wr);
+            nfds = i + 1;
+        }
+        if (SL_FD_ISSET(i, &w->ex))
+        {
+            SL_FD_SET(i, ex);
+            nfds = i + 1;
+        }
+    }
+    return nfds;
+}
+
+/** Copy the part of a result set a waiter asked for to its caller's set.
+ * @param i descriptor
+ * @param requested set the waiter asked for
+ * @param result set returned by sl_Select()
+ * @param out caller's set, may be NULL
+ * @return 1 if the descriptor is ready, else 0
+ */
+static int waiter_copy(int i, SlFdSet_t *requested, SlFdSet_t *result,
+                       SlFdSet_t *out)
+{
+    if (SL_FD_ISSET(i, requested) && SL_FD_ISSET(i, result))
+    {
+        if (out)
+        {
+            SL_FD_SET(i, out);
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/** Test if a waiter can be answered, and if so fill in its caller's sets
+ * and result.  Must be called with the critical section held.
+ * @param w waiter
+ * @param result result of the last sl_Select(), 0 if none was made
+ * @param rd read set returned by the last sl_Select()
+ * @param wr write set returned by the last sl_Select()
+ * @param ex error set returned by the last sl_Select()
+ * @param now current bsd_clock_ms()
+ * @return non-zero if the waiter has been answered
+ */
+static int waiter_answer(struct select_waiter *w, int16_t result,
+                         SlFdSet_t *rd, SlFdSet_t *wr, SlFdSet_t *ex,
+                         uint32_t now)
+{
+    int count = 0;
+    int host = 0;
+    int nwp = 0;
+
+    for (int i = 0; i < w->nfds; ++i)
+    {
+        if (SL_FD_ISSET(i, &w->rd) || SL_FD_ISSET(i, &w->wr) ||
+            SL_FD_ISSET(i, &w->ex))
+        {
+            nwp = 1;
+        }
+        if (result > 0)
+        {
+            count += waiter_copy(i, &w->rd, rd, NULL) +
+                     waiter_copy(i, &w->wr, wr, NULL) +
+                     waiter_copy(i, &w->ex, ex, NULL);
+        }
+        if (w->host_wait && SL_FD_ISSET(i, w->host_wait) &&
+            bsd_socket_rx_ready(i))
+        {
+            ++host;
+        }
+    }
+
+    if (nwp && !w->polled && !(w->intr && *w->intr))
+    {
+        /* registered after the last sl_Select() was set up, a zero
+         * timeout must still see the network processor's answer
+         */
+        return 0;
+    }
+
+    if (count == 0 && host == 0 && !(result < 0 && nwp) &&
+        !(w->intr && *w->intr) &&
+        !(w->timed && (int32_t)(now - w->deadline) >= 0))
+    {
+        return 0;
+    }
+
+    if (w->readfds)
+    {
+        SL_FD_ZERO(w->readfds);
+    }
+    if (w->writefds)
+    {
+        SL_FD_ZERO(w->writefds);
+    }
+    if (w->exceptfds)
+    {
+        SL_FD_ZERO(w->exceptfds);
+    }
+    for (int i = 0; i < w->nfds && count; ++i)
+    {
+        waiter_copy(i, &w->rd, rd, w->readfds);
+        waiter_copy(i, &w->wr, wr, w->writefds);
+        waiter_copy(i, &w->ex, ex, w->exceptfds);
+    }
+    for (int i = 0; i < w->nfds && host; ++i)
+    {
+        if (SL_FD_ISSET(i, w->host_wait) && bsd_socket_rx_ready(i))
+        {
+            SL_FD_SET(i, w->host_ready);
+        }
+    }
+
+    w->result = (result < 0 && nwp && host == 0) ? result : count;
+    return 1;
+}
+
+/** Answer every waiter that can be answered.
+ * @param result result of the last sl_Select(), 0 if none was made
+ * @param rd read set returned by the last sl_Select()
+ * @param wr write set returned by the last sl_Select()
+ * @param ex error set returned by the last sl_Select()
+ */
+static void waiters_answer(int16_t result, SlFdSet_t *rd, SlFdSet_t *wr,
+                           SlFdSet_t *ex)
+{
+    struct select_waiter *answered = NULL;
+
+    unsigned long key = bsd_lock();
+    uint32_t now = bsd_clock_ms();
+    struct select_waiter **prev = &waiters;
+    while (*prev)
+    {
+        struct select_waiter *w = *prev;
+        if (waiter_answer(w, result, rd, wr, ex, now))
+        {
+            *prev = w->next;
+            w->next = answered;
+            answered = w;
+        }
+        else
+        {
+            prev = &w->next;
+        }
+    }
+    bsd_unlock(key);
+
+    while (answered)
+    {
+        /* the waiter is gone as soon as it is signaled */
+        struct select_waiter *w = answered;
+        answered = w->next;
+        osi_SyncObjSignal(&w->sem);
+    }
+}
+
+/** Entry point of the select thread, the only caller of sl_Select().  Each
+ * pass waits on the union of the SO_RXDEMUX sockets with room in their
+ * queues and the sets of all waiting threads, until the earliest deadline
+ * among the waiters, or until the receive window of an SO_RCVBUFAUTO socket
+ * may need to shrink.  A thread that starts waiting interrupts the current
+ * sl_Select() with a datagram to wake_fd.
+ * @param arg unused
+ */
+static void select_thread(void *arg)
+{
+    wake_open();
+
+    for ( ; /* forever */ ; )
+    {
+        SlFdSet_t demux, rd, wr, ex;
+        SL_FD_ZERO(&wr);
+        SL_FD_ZERO(&ex);
+        int nfds = bsd_async_recv_fds(&demux);
+        rd = demux;
+
+        uint32_t wait = bsd_rcvbuf_idle();
+        unsigned long key = bsd_lock();
+        uint32_t now = bsd_clock_ms();
+        for (struct select_waiter *w = waiters; w; w = w->next)
+        {
+            int n = waiter_merge(w, &rd, &wr, &ex);
+            w->polled = 1;
+            if (n > nfds)
+            {
+                nfds = n;
+            }
+            if (w->timed)
+            {
+                int32_t left = w->deadline - now;
+                if (left <= 0)
+                {
+                    wait = 0;
+                }
+                else if ((uint32_t)left < wait)
+                {
+                    wait = left;
+                }
+            }
+        }
+        if (nfds)
+        {
+            in_select = 1;
+            wake_sent = 0;
+        }
+        bsd_unlock(key);
+
+        if (nfds == 0)
+        {
+            /* nothing to ask the network processor, only host side state
+             * and deadlines to wait for
+             */
+            if (wait)
+            {
+                osi_SyncObjWait(&work_sem, wait);
+            }
+            waiters_answer(0, &rd, &wr, &ex);
+            continue;
+        }
+
+        if (wake_fd >= 0)
+        {
+            SL_FD_SET(wake_fd, &rd);
+            if (wake_fd >= nfds)
+            {
+                nfds = wake_fd + 1;
+            }
+        }
+        else if (wait > BSD_SELECT_POLL_MS)
+        {
+            /* nothing can interrupt sl_Select(), newly registered work is
+             * picked up after at most this long
+             */
+            wait = BSD_SELECT_POLL_MS;
+        }
+
+        SlTimeval_t tv;
+        bsd_ms_to_timeval(&tv, wait);
+        int16_t result = sl_Select(nfds, &rd, &wr, &ex,
+                                   wait == OSI_WAIT_FOREVER ? NULL : &tv);
+        in_select = 0;
+
+        if (result > 0 && wake_fd >= 0 && SL_FD_ISSET(wake_fd, &rd))
+        {
+            uint8_t byte;
+            sl_Recv(wake_fd, &byte, 1, 0);
+            SL_FD_CLR(wake_fd, &rd);
+            --result;
+        }
+
+        if (result > 0)
+        {
+            bsd_async_recv_service(nfds, &demux, &rd);
+        }
+        waiters_answer(result, &rd, &wr, &ex);
+    }
+}
+
+/** Start the select thread if it is not already running.
+ * @return 0 upon success, otherwise -1
+ */
+static int thread_start(void)
+{
+    unsigned long key = bsd_lock();
+    if (thread_state != THREAD_STOPPED)
+    {
+        bsd_unlock(key);
+        while (thread_state == THREAD_STARTING)
+        {
+            osi_Sleep(1);
+        }
+        return thread_state == THREAD_RUNNING ? 0 : -1;
+    }
+    thread_state = THREAD_STARTING;
+    bsd_unlock(key);
+
+    if (osi_SyncObjCreate(&work_sem) != OSI_OK)
+    {
+        thread_state = THREAD_STOPPED;
+        return -1;
+    }
+    if (osi_TaskCreate(select_thread, (const signed char*)"bsd_select",
+                       BSD_SELECT_STACK_SIZE, NULL,
+                       BSD_SELECT_PRIORITY, NULL) != OSI_OK)
+    {
+        osi_SyncObjDelete(&work_sem);
+        thread_state = THREAD_STOPPED;
+        return -1;
+    }
+
+    thread_state = THREAD_RUNNING;
+    return 0;
+}
+
+/*
+ * bsd_select_start()
+ */
+int bsd_select_start(void)
+{
+    if (thread_start() < 0)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * bsd_select_kick()
+ */
+void bsd_select_kick(void)
+{
+    if (thread_state != THREAD_RUNNING)
+    {
+        return;
+    }
+
+    unsigned long key = bsd_lock();
+    int send = in_select && !wake_sent && wake_fd >= 0;
+    if (send)
+    {
+        wake_sent = 1;
+    }
+    bsd_unlock(key);
+
+    if (send)
+    {
+        uint8_t byte = 0;
+        sl_SendTo(wake_fd, &byte, 1, 0, (SlSockAddr_t*)&wake_addr,
+                  sizeof(wake_addr));
+    }
+    else
+    {
+        osi_SyncObjSignal(&work_sem);
+    }
+}
+
+/** Hand a set of sockets to the select thread and wait for its answer.
+ * @param nfds highest numbered file descriptor in any of the three sets
+ *             plus 1
+ * @param readfds set to pend on read active, may be NULL
+ * @param writefds set to pend on write active, may be NULL
+ * @param exceptfds set to pend on error active, may be NULL
+ * @param timeout time to wait, NULL to wait forever
+ * @param host_wait SO_RXDEMUX sockets to wait for, may be NULL
+ * @param host_ready receives the host_wait sockets that became ready
+ * @param intr return as timed out once this is set, may be NULL
+ * @return result of sl_Select() restricted to the given sets
+ */
+static int16_t select_wait(int nfds, SlFdSet_t *readfds, SlFdSet_t *writefds,
+                           SlFdSet_t *exceptfds, SlTimeval_t *timeout,
+                           SlFdSet_t *host_wait, SlFdSet_t *host_ready,
+                           volatile uint8_t *intr)
+{
+    struct select_waiter w;
+
+    if (thread_start() < 0 || osi_SyncObjCreate(&w.sem) != OSI_OK)
+    {
+        return SL_POOL_IS_EMPTY;
+    }
+
+    w.readfds = readfds;
+    w.writefds = writefds;
+    w.exceptfds = exceptfds;
+    w.host_wait = host_wait;
+    w.host_ready = host_ready;
+    w.intr = intr;
+    w.nfds = nfds < SL_MAX_SOCKETS ? nfds : SL_MAX_SOCKETS;
+    w.result = 0;
+    w.timed = timeout != NULL;
+    w.polled = 0;
+    w.deadline = bsd_clock_ms();
+    if (timeout)
+    {
+        w.deadline += timeout->tv_sec * 1000 + timeout->tv_usec / 1000;
+    }
+    SL_FD_ZERO(&w.rd);
+    SL_FD_ZERO(&w.wr);
+    SL_FD_ZERO(&w.ex);
+    if (readfds)
+    {
+        w.rd = *readfds;
+    }
+    if (writefds)
+    {
+        w.wr = *writefds;
+    }
+    if (exceptfds)
+    {
+        w.ex = *exceptfds;
+    }
+
+    unsigned long key = bsd_lock();
+    if (intr && *intr)
+    {
+        bsd_unlock(key);
+        osi_SyncObjDelete(&w.sem);
+        return 0;
+    }
+    w.next = waiters;
+    waiters = &w;
+    bsd_unlock(key);
+
+    bsd_select_kick();
+    osi_SyncObjWait(&w.sem, OSI_WAIT_FOREVER);
+    osi_SyncObjDelete(&w.sem);
+
+    return w.result;
+}
+
+/*
+ * bsd_select()
+ */
+int16_t bsd_select(int nfds, SlFdSet_t *readfds, SlFdSet_t *writefds,
+                   SlFdSet_t *exceptfds, SlTimeval_t *timeout)
+{
+    return select_wait(nfds, readfds, writefds, exceptfds, timeout, NULL,
+                       NULL, NULL);
+}
+
+/*
+ * bsd_select_intr()
+ */
+int16_t bsd_select_intr(int nfds, SlFdSet_t *readfds, SlFdSet_t *writefds,
+                        SlFdSet_t *exceptfds, SlTimeval_t *timeout,
+                        volatile uint8_t *intr)
+{
+    return select_wait(nfds, readfds, writefds, exceptfds, timeout, NULL,
+                       NULL, intr);
+}
 
 /*
  * ::select()
@@ -48,13 +571,93 @@ int select(int nfds, fd_set *readfds, fd_set *writefds,
            fd_set *exceptfds, struct timeval *timeout)
 {
     SlTimeval_t tv;
+    SlTimeval_t *tv_ptr = NULL;
     if (timeout)
     {
         tv.tv_sec = timeout->tv_sec;
         tv.tv_usec = timeout->tv_usec;
+        tv_ptr = &tv;
     }
 
-    int16_t result = sl_Select(nfds, readfds, writefds, exceptfds, timeout ? &tv : NULL);
+    /* sockets with data already buffered on the host are readable now, the
+     * network processor only needs to be polled for the remainder, and never
+     * for sockets owned by the select thread, nor for sockets whose network
+     * processor socket shutdown(SHUT_RDWR) closed, as their recv() returns
+     * 0 and their send() fails with EPIPE at once
+     */
+    fd_set buffered;
+    fd_set writable;
+    fd_set demux_wait;
+    int ready_count = 0;
+    int demux_count = 0;
+    FD_ZERO(&buffered);
+    FD_ZERO(&writable);
+    FD_ZERO(&demux_wait);
+    for (int i = 0; i < nfds && i < SL_MAX_SOCKETS; ++i)
+    {
+        if (bsd_sockets[i].shut & BSD_SHUT_CLOSED)
+        {
+            if (readfds && FD_ISSET(i, readfds))
+            {
+                FD_CLR(i, readfds);
+                FD_SET(i, &buffered);
+                ++ready_count;
+            }
+            if (writefds && FD_ISSET(i, writefds))
+            {
+                FD_CLR(i, writefds);
+                FD_SET(i, &writable);
+                ++ready_count;
+            }
+            if (exceptfds)
+            {
+                FD_CLR(i, exceptfds);
+            }
+            continue;
+        }
+        if (!readfds || !FD_ISSET(i, readfds))
+        {
+            continue;
+        }
+        if (bsd_socket_rx_ready(i))
+        {
+            FD_SET(i, &buffered);
+            ++ready_count;
+        }
+        if (bsd_socket_rx_demux(i))
+        {
+            FD_CLR(i, readfds);
+            if (!bsd_socket_rx_ready(i))
+            {
+                FD_SET(i, &demux_wait);
+                ++demux_count;
+            }
+        }
+    }
+    if (ready_count)
+    {
+        tv.tv_sec = 0;
+        tv.tv_usec = 0;
+        tv_ptr = &tv;
+    }
+
+    int16_t result = select_wait(nfds, readfds, writefds, exceptfds, tv_ptr,
+                                 demux_count ? &demux_wait : NULL, &buffered,
+                                 NULL);
+
+    for (int i = 0; result >= 0 && i < nfds && i < SL_MAX_SOCKETS; ++i)
+    {
+        if (FD_ISSET(i, &buffered) && !FD_ISSET(i, readfds))
+        {
+            FD_SET(i, readfds);
+            ++result;
+        }
+        if (FD_ISSET(i, &writable))
+        {
+            FD_SET(i, writefds);
+            ++result;
+        }
+    }
 
     if (result < 0)
     {
@@ -31,6 +31,11 @@
  * @date 31 July 2016
  */
 
+#if !defined(__TI_COMPILER_VERSION__)
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -39,65 +44,232 @@
 #include <unistd.h>
 
 #include "socket.h"
+#include "bsd_socket_priv.h"
 
 int h_errno;
 
+struct bsd_socket bsd_sockets[SL_MAX_SOCKETS];
+
 /*
- * ::socket()
+ * bsd_clock_ms()
  */
-int socket(int domain, int type, int protocol)
+#if defined(__TI_COMPILER_VERSION__)
+#pragma WEAK(bsd_clock_ms)
+uint32_t bsd_clock_ms(void)
+{
+    return (uint32_t)((uint64_t)clock() * 1000 / CLOCKS_PER_SEC);
+}
+#else
+uint32_t __attribute__((weak)) bsd_clock_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+#endif
+
+/** Reset the host side state of a newly created socket.
+ * @param s socket descriptor returned by the network processor
+ * @param type POSIX socket type
+ */
+static void socket_state_open(int s, int type)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock)
+    {
+        /* the network processor may hand out a descriptor again before the
+         * close() that released it has torn down its host side state
+         */
+        while (sock->closing)
+        {
+            usleep(1000);
+        }
+        memset(sock, 0, sizeof(*sock));
+        sock->type = type;
+        sock->opts = BSD_OPT_REUSEADDR | BSD_OPT_NODELAY;
+        sock->keepalive = 1;
+    }
+}
+
+/** Test if the network processor handed out a descriptor that
+ * shutdown(SHUT_RDWR) released but that has not been closed yet.  If so,
+ * the new network processor socket is kept to hold the descriptor until
+ * close(), so that close() of the old socket cannot close a new one.
+ * @param s socket descriptor returned by the network processor
+ * @return non-zero if the socket now holds the descriptor
+ */
+static int socket_state_hold(int s)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+    int hold = 0;
+
+    if (sock)
+    {
+        unsigned long key = bsd_lock();
+        if ((sock->shut & BSD_SHUT_CLOSED) && !sock->closing)
+        {
+            sock->shut |= BSD_SHUT_HELD;
+            hold = 1;
+        }
+        bsd_unlock(key);
+    }
+    return hold;
+}
+
+/** Mark a socket as being closed, before the network processor socket is
+ * released.  The select thread stops serving it, threads blocked in
+ * recv() on it fail with EBADF, and socket_state_open() of a socket that
+ * reuses the descriptor waits for socket_state_close().
+ * @param s socket descriptor being closed
+ * @return non-zero if there is a network processor socket to close
+ */
+static int socket_state_closing(int s)
 {
-    switch (domain)
+    struct bsd_socket *sock = bsd_socket_get(s);
+    int open = 1;
+
+    if (sock)
+    {
+        unsigned long key = bsd_lock();
+        sock->closing = 1;
+        if ((sock->shut & (BSD_SHUT_CLOSED | BSD_SHUT_HELD)) ==
+            BSD_SHUT_CLOSED)
+        {
+            /* shutdown() already closed it, and nothing holds it since */
+            open = 0;
+        }
+        if (sock->rx_demux)
+        {
+            sock->rx_demux = 0;
+            sock->rx_eof = 1;
+            sock->error = EBADF;
+        }
+        bsd_unlock(key);
+        if (sock->rx_sem)
+        {
+            osi_SyncObjSignal(&sock->rx_sem);
+        }
+    }
+    return open;
+}
+
+/** Release the host side state of a closed socket, which clears the mark
+ * set by socket_state_closing().
+ * @param s socket descriptor being closed
+ */
+static void socket_state_close(int s)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock)
+    {
+        /* a thread draining the transmit queue fails quickly once the
+         * network processor socket is gone
+         */
+        while (sock->tx_busy || sock->rx_busy || sock->rx_readers)
+        {
+            if (sock->rx_readers)
+            {
+                /* each blocked reader consumes one signal */
+                osi_SyncObjSignal(&sock->rx_sem);
+            }
+            usleep(1000);
+        }
+        bsd_txq_purge(sock);
+
+        unsigned long key = bsd_lock();
+        uint8_t *rx_buf = sock->rx_buf;
+        OsiSyncObj_t rx_sem = sock->rx_sem;
+        memset(sock, 0, sizeof(*sock));
+        bsd_unlock(key);
+        free(rx_buf);
+        if (rx_sem)
+        {
+            osi_SyncObjDelete(&rx_sem);
+        }
+    }
+}
+
+/*
+ * bsd_socket_translate()
+ */
+int bsd_socket_translate(int *domain, int *type, int *protocol)
+{
+    switch (*domain)
     {
         case AF_INET:
-            domain = SL_AF_INET;
+            *domain = SL_AF_INET;
             break;
         case AF_INET6:
-            domain = SL_AF_INET6;
+            *domain = SL_AF_INET6;
             break;
         case AF_PACKET:
-            domain = SL_AF_PACKET;
+            *domain = SL_AF_PACKET;
             break;
         default:
             errno = EAFNOSUPPORT;
             return -1;
     }
 
-    switch (type)
+    switch (*type)
     {
         case SOCK_STREAM:
-            type = SL_SOCK_STREAM;
+            *type = SL_SOCK_STREAM;
             break;
         case SOCK_DGRAM:
-            type = SL_SOCK_DGRAM;
+            *type = SL_SOCK_DGRAM;
             break;
         case SOCK_RAW:
-            type = SL_SOCK_RAW;
+            *type = SL_SOCK_RAW;
             break;
         default:
             errno = EINVAL;
             return -1;
     }
 
-    switch (protocol)
+    switch (*protocol)
     {
         case 0:
             break;
         case IPPROTO_TCP:
-            protocol = SL_IPPROTO_TCP;
+            *protocol = SL_IPPROTO_TCP;
             break;
         case IPPROTO_UDP:
-            protocol = SL_IPPROTO_UDP;
+            *protocol = SL_IPPROTO_UDP;
             break;
         case IPPROTO_RAW:
-            protocol = SL_IPPROTO_RAW;
+            *protocol = SL_IPPROTO_RAW;
             break;
         default:
             errno = EINVAL;
             return -1;
     }
 
-    int result = sl_Socket(domain, type, protocol);
+    return 0;
+}
+
+/*
+ * bsd_socket_open()
+ */
+int bsd_socket_open(int sl_domain, int sl_type, int sl_protocol, int type)
+{
+    int result;
+
+    for ( ; /* forever */ ; )
+    {
+        result = sl_Socket(sl_domain, sl_type, sl_protocol);
+        if (result >= 0 && socket_state_hold(result))
+        {
+            /* the descriptor is still reserved by a shut down socket */
+            continue;
+        }
+        if (result != SL_ENSOCK || !bsd_connpool_evict())
+        {
+            break;
+        }
+        /* an idle pooled connection gave its socket back, try again */
+    }
 
     if (result < 0)
     {
@@ -134,35 +306,58 @@ int socket(int domain, int type, int protocol)
         }
         return -1;
     }
-    
+
+    socket_state_open(result, type);
     return result;
 }
 
 /*
- * ::bind()
+ * ::socket()
  */
-int bind(int s, const struct sockaddr *address, socklen_t address_len)
+int socket(int domain, int type, int protocol)
+{
+    int posix_type = type;
+
+    if (bsd_socket_translate(&domain, &type, &protocol) < 0)
+    {
+        return -1;
+    }
+
+    return bsd_socket_open(domain, type, protocol, posix_type);
+}
+
+/*
+ * bsd_sockaddr_translate()
+ */
+int bsd_sockaddr_translate(const struct sockaddr *address,
+                           SlSockAddr_t *sl_address)
 {
-    SlSockAddr_t sl_address;
     switch (address->sa_family)
     {
         case AF_INET:
-            sl_address.sa_family = SL_AF_INET;
+            sl_address->sa_family = SL_AF_INET;
             break;
         case AF_INET6:
-            sl_address.sa_family = SL_AF_INET6;
+            sl_address->sa_family = SL_AF_INET6;
             break;
         case AF_PACKET:
-            sl_address.sa_family = SL_AF_PACKET;
+            sl_address->sa_family = SL_AF_PACKET;
             break;
         default:
             errno = EAFNOSUPPORT;
             return -1;
     }
 
-    memcpy(sl_address.sa_data, address->sa_data, sizeof(sl_address.sa_data));
+    memcpy(sl_address->sa_data, address->sa_data, sizeof(sl_address->sa_data));
+    return 0;
+}
 
-    int result = sl_Bind(s, &sl_address, address_len);
+/*
+ * bsd_bind()
+ */
+int bsd_bind(int s, const SlSockAddr_t *sl_address, socklen_t address_len)
+{
+    int result = sl_Bind(s, sl_address, address_len);
 
     if (result < 0)
     {
@@ -177,9 +372,32 @@ int bind(int s, const struct sockaddr *address, socklen_t address_len)
         return -1;
     }
  
+    struct bsd_socket *sock = bsd_socket_get(s);
+    if (sock && sl_address->sa_family == SL_AF_INET)
+    {
+        /* remembered for getsockname() */
+        memcpy(&sock->local, sl_address, sizeof(sock->local));
+        sock->opts |= BSD_OPT_LOCAL;
+    }
+
     return 0;  
 }
 
+/*
+ * ::bind()
+ */
+int bind(int s, const struct sockaddr *address, socklen_t address_len)
+{
+    SlSockAddr_t sl_address;
+
+    if (bsd_sockaddr_translate(address, &sl_address) < 0)
+    {
+        return -1;
+    }
+
+    return bsd_bind(s, &sl_address, address_len);
+}
+
 /*
  * ::listen()
  */
@@ -201,6 +419,27 @@ int listen(int s, int backlog)
     return 0;  
 }
 
+/** Copy a SimpleLink IPv4 address out to the application, truncating it if
+ * the destination is too small.
+ * @param sl_address SimpleLink IPv4 address
+ * @param address destination
+ * @param address_len on input the size of address, on output the size of a
+ *                    struct sockaddr_in
+ */
+static void sockaddr_in_out(const SlSockAddrIn_t *sl_address,
+                            struct sockaddr *address, socklen_t *address_len)
+{
+    struct sockaddr_in addr_in;
+    memset(&addr_in, 0, sizeof(addr_in));
+    addr_in.sin_family = AF_INET;
+    addr_in.sin_port = sl_address->sin_port;
+    addr_in.sin_addr.s_addr = sl_address->sin_addr.s_addr;
+
+    memcpy(address, &addr_in, *address_len < sizeof(addr_in) ?
+                              *address_len : sizeof(addr_in));
+    *address_len = sizeof(addr_in);
+}
+
 /*
  * ::accept()
  */
@@ -208,14 +447,27 @@ int accept(int s, struct sockaddr *address, socklen_t *address_len)
 {
     SlSockAddr_t sl_address;
     SlSocklen_t sl_address_len;
+    struct bsd_socket *sock = bsd_socket_get(s);
 
-    int result = sl_Accept(s, &sl_address, &sl_address_len);
-
-    if (address && address_len)
+    if (sock && sock->rcvtimeo && !sock->nonblock)
     {
-        memcpy(address, &sl_address, *address_len);
+        /* SO_RCVTIMEO is enforced on the host for accept() */
+        SlTimeval_t tv;
+        bsd_ms_to_timeval(&tv, sock->rcvtimeo);
+        int ready = bsd_wait_ready(s, 0, &tv);
+        if (ready <= 0)
+        {
+            if (ready == 0)
+            {
+                errno = EAGAIN;
+            }
+            return -1;
+        }
     }
 
+    sl_address_len = sizeof(sl_address);
+    int result = sl_Accept(s, &sl_address, &sl_address_len);
+
     if (result < 0)
     {
         switch (result)
@@ -233,146 +485,778 @@ int accept(int s, struct sockaddr *address, socklen_t *address_len)
         return -1;
     }
 
+    socket_state_open(result, SOCK_STREAM);
+
+    struct bsd_socket *peer_sock = bsd_socket_get(result);
+    if (peer_sock && sl_address.sa_family == SL_AF_INET)
+    {
+        /* remembered for getpeername() and getsockname() */
+        memcpy(&peer_sock->peer, &sl_address, sizeof(peer_sock->peer));
+        peer_sock->opts |= BSD_OPT_PEER;
+        if (sock && (sock->opts & BSD_OPT_LOCAL))
+        {
+            peer_sock->local = sock->local;
+            peer_sock->opts |= BSD_OPT_LOCAL;
+        }
+    }
+
+    if (address && address_len)
+    {
+        if (sl_address.sa_family == SL_AF_INET)
+        {
+            sockaddr_in_out((SlSockAddrIn_t*)&sl_address, address,
+                            address_len);
+        }
+        else
+        {
+            *address_len = 0;
+        }
+    }
+
     return result;
 }
 
-/*
- * ::connect()
+/** Translate a failed sl_Connect() result into errno.
+ * @param result negative result from sl_Connect()
+ * @return -1
  */
-int connect(int s, const struct sockaddr *address, socklen_t address_len)
+static int connect_error(int result)
 {
-    SlSockAddr_t sl_address;
-    sl_address.sa_family = address->sa_family;
-    memcpy(sl_address.sa_data, address->sa_data, sizeof(sl_address.sa_data));
-
-    int result = sl_Connect(s, &sl_address, address_len);
-
-    if (result < 0)
+    switch (result)
     {
-        switch (result)
+        default:
         {
-            default:
+            if (!bsd_conn_error(result))
             {
                 errno = EINVAL;
-                break;
             }
-            case SL_EALREADY:
-                errno = EALREADY;
-                break;
-            case SL_POOL_IS_EMPTY:
-                usleep(10000);
-            /* fall through */
-            case SL_EAGAIN:
-                errno = EAGAIN;
-                break;
+            break;
         }
-        return -1;
+#if defined(SL_ECONNREFUSED)
+        case SL_ECONNREFUSED:
+            errno = ECONNREFUSED;
+            break;
+#endif
+        case SL_EALREADY:
+            errno = EALREADY;
+            break;
+        case SL_POOL_IS_EMPTY:
+            usleep(10000);
+        /* fall through */
+        case SL_EAGAIN:
+            errno = EAGAIN;
+            break;
     }
-
-    return 0;  
+    return -1;
 }
 
-/*
- * ::recv()
+/** Connect a blocking socket with the SO_SNDTIMEO deadline enforced on the
+ * host.  The connection is made in non-blocking mode, waiting for completion
+ * with bsd_select().
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @param sl_address peer address
+ * @param address_len length of sl_address
+ * @return 0 upon success, otherwise -1 with errno set, ETIMEDOUT if the
+ *         deadline passed
  */
-int recv(int s, void *buffer, size_t length, int flags)
+static int connect_timed(int s, struct bsd_socket *sock,
+                         const SlSockAddr_t *sl_address,
+                         socklen_t address_len)
 {
-    int result = sl_Recv(s, buffer, length, flags);
+    if (bsd_set_nonblocking(s, 1) < 0)
+    {
+        return -1;
+    }
 
-    if (result < 0)
+    uint32_t start = bsd_clock_ms();
+    int result;
+    for ( ; /* forever */ ; )
     {
-        switch (result)
+        result = sl_Connect(s, sl_address, address_len);
+        if (result != SL_EALREADY)
         {
-            default:
-                errno = EINVAL;
-                break;
-            case SL_POOL_IS_EMPTY:
-                usleep(10000);
-                /* fall through */
-            case SL_EAGAIN:
-                errno = EAGAIN;
-                break;
+            result = result < 0 ? connect_error(result) : 0;
+            break;
+        }
+
+        uint32_t elapsed = bsd_clock_ms() - start;
+        if (elapsed >= sock->sndtimeo)
+        {
+            errno = ETIMEDOUT;
+            result = -1;
+            break;
+        }
+
+        SlTimeval_t tv;
+        bsd_ms_to_timeval(&tv, sock->sndtimeo - elapsed);
+        if (bsd_wait_ready(s, 1, &tv) < 0)
+        {
+            result = -1;
+            break;
         }
-        return -1;
     }
 
-    return result;  
+    int error = errno;
+    bsd_set_nonblocking(s, 0);
+    errno = error;
+
+    return result;
 }
 
-/*
- * ::send()
+/** Set or dissolve the default peer of a SOCK_DGRAM socket.  This is
+ * handled entirely on the host, the destination of each datagram is given
+ * to the network processor by sl_SendTo().
+ * @param sock host side socket state
+ * @param address peer address, AF_UNSPEC to dissolve the association
+ * @param address_len length of address
+ * @return 0 upon success, otherwise -1 with errno set
  */
-int send(int s, const void *buffer, size_t length, int flags)
+static int dgram_connect(struct bsd_socket *sock,
+                         const struct sockaddr *address,
+                         socklen_t address_len)
 {
-    int result = sl_Send(s, buffer, length, flags);
+    if (address->sa_family == AF_UNSPEC)
+    {
+        unsigned long key = bsd_lock();
+        sock->opts &= ~BSD_OPT_PEER;
+        bsd_unlock(key);
+        return 0;
+    }
 
-    if (result < 0)
+    if (address_len < sizeof(struct sockaddr_in))
     {
-        switch (result)
-        {
-            default:
-                errno = EINVAL;
-                break;
-        }
+        errno = EINVAL;
         return -1;
     }
 
-    return result;  
+    const struct sockaddr_in *addr_in = (const struct sockaddr_in*)address;
+    unsigned long key = bsd_lock();
+    memset(&sock->peer, 0, sizeof(sock->peer));
+    sock->peer.sin_family = SL_AF_INET;
+    sock->peer.sin_port = addr_in->sin_port;
+    sock->peer.sin_addr.s_addr = addr_in->sin_addr.s_addr;
+    sock->opts |= BSD_OPT_PEER;
+    bsd_unlock(key);
+
+    return 0;
 }
 
 /*
- * ::sendto()
+ * ::connect()
  */
-int recvfrom(int s, void *buffer, size_t length, int flags,
-             struct sockaddr *src_addr, socklen_t *addrlen)
+int connect(int s, const struct sockaddr *address, socklen_t address_len)
 {
-    SlSockAddr_t sl_sockaddr;
-    SlSocklen_t sl_addrlen = sizeof(SlSockAddr_t);
+    SlSockAddr_t sl_address;
+    sl_address.sa_family = address->sa_family;
+    memcpy(sl_address.sa_data, address->sa_data, sizeof(sl_address.sa_data));
 
-    int result = sl_RecvFrom(s, buffer, length, flags, &sl_sockaddr,
-                             &sl_addrlen);
+    struct bsd_socket *sock = bsd_socket_get(s);
+    if (sock && sock->type == SOCK_DGRAM &&
+        (address->sa_family == AF_UNSPEC || address->sa_family == AF_INET))
+    {
+        return dgram_connect(sock, address, address_len);
+    }
 
-    if (src_addr != NULL)
+    int result;
+    if (sock && sock->sndtimeo && !sock->nonblock)
     {
-        switch (sl_sockaddr.sa_family)
+        result = connect_timed(s, sock, &sl_address, address_len);
+    }
+    else
+    {
+        result = sl_Connect(s, &sl_address, address_len);
+        if (result == SL_EALREADY && sock)
         {
-            default:
-                errno = EAFNOSUPPORT;
-                return -1;
-            case SL_AF_INET:
-            {
-                if (sizeof(struct sockaddr_in) < *addrlen)
-                {
-                    break;
-                }
-                struct sockaddr_in *addr_in = (struct sockaddr_in *)src_addr;
-                SlSockAddrIn_t *sl_addr_in = (SlSockAddrIn_t*)&sl_sockaddr;
-
-                addr_in->sin_family = AF_INET;
-                addr_in->sin_port = sl_addr_in->sin_port;
-                addr_in->sin_addr.s_addr = sl_addr_in->sin_addr.s_addr;
-                break;
-            }
+            /* SimpleLink reports every attempt of a non-blocking connect as
+             * already in progress, only the ones after the first are
+             */
+            unsigned long key = bsd_lock();
+            errno = sock->connecting ? EALREADY : EINPROGRESS;
+            sock->connecting = 1;
+            bsd_unlock(key);
+            return -1;
+        }
+        if (sock)
+        {
+            sock->connecting = 0;
+        }
+        if (result < 0)
+        {
+            return connect_error(result);
         }
     }
 
-    if (result < 0)
+    if (result == 0 && sock && address->sa_family == AF_INET)
     {
-        switch (result)
-        {
-            default:
+        /* remembered for getpeername() */
+        memcpy(&sock->peer, &sl_address, sizeof(sock->peer));
+        sock->opts |= BSD_OPT_PEER;
+    }
+
+    return result;  
+}
+
+/*
+ * ::getsockname()
+ */
+int getsockname(int s, struct sockaddr *address, socklen_t *address_len)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    SlSockAddrIn_t local;
+    if (sock->opts & BSD_OPT_LOCAL)
+    {
+        local = sock->local;
+    }
+    else
+    {
+        /* not bound yet, or bound by the network processor to a port we
+         * were never told about
+         */
+        memset(&local, 0, sizeof(local));
+        local.sin_family = SL_AF_INET;
+    }
+
+    sockaddr_in_out(&local, address, address_len);
+    return 0;
+}
+
+/*
+ * ::getpeername()
+ */
+int getpeername(int s, struct sockaddr *address, socklen_t *address_len)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    unsigned long key = bsd_lock();
+    SlSockAddrIn_t peer = sock->peer;
+    int connected = sock->opts & BSD_OPT_PEER;
+    bsd_unlock(key);
+
+    if (!connected)
+    {
+        errno = ENOTCONN;
+        return -1;
+    }
+
+    sockaddr_in_out(&peer, address, address_len);
+    return 0;
+}
+
+/*
+ * bsd_recv_error()
+ */
+int bsd_recv_error(int result)
+{
+    switch (result)
+    {
+        default:
+            if (!bsd_conn_error(result))
+            {
                 errno = EINVAL;
-                break;
-            case SL_POOL_IS_EMPTY:
-                usleep(10000);
-                /* fall through */
-            case SL_EAGAIN:
+            }
+            break;
+        case SL_POOL_IS_EMPTY:
+            usleep(10000);
+            /* fall through */
+        case SL_EAGAIN:
+            errno = EAGAIN;
+            break;
+    }
+    return -1;
+}
+
+/*
+ * bsd_rx_fill()
+ */
+int bsd_rx_fill(int s, struct bsd_socket *sock)
+{
+    unsigned long key = bsd_lock();
+    if (sock->rx_count == 0)
+    {
+        /* maximize the contiguous free space */
+        sock->rx_head = 0;
+    }
+    unsigned tail = sock->rx_head + sock->rx_count;
+    unsigned space;
+    if (tail >= sock->rx_size)
+    {
+        tail -= sock->rx_size;
+        space = sock->rx_head - tail;
+    }
+    else
+    {
+        space = sock->rx_size - tail;
+    }
+    uint8_t *rx_buf = sock->rx_buf;
+    sock->rx_filling = space != 0;
+    bsd_unlock(key);
+
+    if (space == 0)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    int result = sl_Recv(s, rx_buf + tail, space, 0);
+
+    key = bsd_lock();
+    sock->rx_filling = 0;
+    if (sock->shut & BSD_SHUT_RD)
+    {
+        /* shutdown() left discarding the buffer to us */
+        sock->rx_count = 0;
+    }
+    else if (result > 0)
+    {
+        sock->rx_count += result;
+    }
+    bsd_unlock(key);
+
+    if (result < 0)
+    {
+        return bsd_recv_error(result);
+    }
+    bsd_rcvbuf_account(s, sock, result, space);
+
+    return result;
+}
+
+/*
+ * bsd_rx_copy()
+ */
+int bsd_rx_copy(struct bsd_socket *sock, uint8_t *buffer, size_t length,
+                int peek)
+{
+    unsigned long key = bsd_lock();
+    if (length > sock->rx_count)
+    {
+        length = sock->rx_count;
+    }
+    size_t first = sock->rx_size - sock->rx_head;
+    if (first > length)
+    {
+        first = length;
+    }
+    memcpy(buffer, sock->rx_buf + sock->rx_head, first);
+    memcpy(buffer + first, sock->rx_buf, length - first);
+    if (!peek)
+    {
+        sock->rx_head += length;
+        if (sock->rx_head >= sock->rx_size)
+        {
+            sock->rx_head -= sock->rx_size;
+        }
+        sock->rx_count -= length;
+    }
+    bsd_unlock(key);
+
+    return length;
+}
+
+/*
+ * bsd_wait_ready()
+ */
+int bsd_wait_ready(int s, int write, SlTimeval_t *timeout)
+{
+    SlFdSet_t fds;
+    SL_FD_ZERO(&fds);
+    SL_FD_SET(s, &fds);
+
+    int result = bsd_select(s + 1, write ? NULL : &fds, write ? &fds : NULL,
+                            NULL, timeout);
+
+    if (result < 0)
+    {
+        errno = result == SL_POOL_IS_EMPTY ? ENOMEM : EINVAL;
+        return -1;
+    }
+
+    return result;
+}
+
+/** Fail with EAGAIN instead of blocking for a MSG_DONTWAIT call on a
+ * blocking socket, or instead of blocking beyond SO_SNDTIMEO for a send.
+ * SO_RCVTIMEO is not checked here: the network processor enforces it for a
+ * single sl_Recv() or sl_RecvFrom(), while accept(), demultiplexed receives
+ * and peer_recv() enforce it on the host.
+ * @param s socket descriptor
+ * @param sock host side socket state, may be NULL
+ * @param flags flags given to the send or receive call
+ * @param write true for a send, false for a receive
+ * @return 0 if the call may proceed, otherwise -1 with errno set
+ */
+static int wait_check(int s, struct bsd_socket *sock, int flags, int write)
+{
+    SlTimeval_t tv;
+
+    if (sock == NULL || sock->nonblock)
+    {
+        return 0;
+    }
+    else if (flags & MSG_DONTWAIT)
+    {
+        bsd_ms_to_timeval(&tv, 0);
+    }
+    else if (write && sock->sndtimeo)
+    {
+        bsd_ms_to_timeval(&tv, sock->sndtimeo);
+    }
+    else
+    {
+        return 0;
+    }
+
+    int result = bsd_wait_ready(s, write, &tv);
+    if (result == 0)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    return result < 0 ? -1 : 0;
+}
+
+/** Receive through the read-ahead buffer of a socket.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @param buffer buffer where the message should be stored
+ * @param length length in bytes of the buffer
+ * @param flags MSG_PEEK and/or MSG_DONTWAIT, or 0
+ * @return see recv()
+ */
+static int readahead_recv(int s, struct bsd_socket *sock, void *buffer,
+                          size_t length, int flags)
+{
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (sock->rx_count == 0)
+    {
+        if (wait_check(s, sock, flags, 0) < 0)
+        {
+            return -1;
+        }
+
+        if (length >= sock->rx_size && !(flags & MSG_PEEK))
+        {
+            /* nothing to gain from staging a large read */
+            int result = sl_Recv(s, buffer, length, 0);
+            if (result < 0)
+            {
+                return bsd_recv_error(result);
+            }
+            bsd_rcvbuf_account(s, sock, result, length);
+            return result;
+        }
+
+        int result = bsd_rx_fill(s, sock);
+        if (result <= 0)
+        {
+            return result;
+        }
+    }
+
+    return bsd_rx_copy(sock, buffer, length, flags & MSG_PEEK);
+}
+
+/** Receive on a SOCK_DGRAM socket with a default peer, discarding datagrams
+ * from any other source.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @param buffer buffer where the message should be stored
+ * @param length length in bytes of the buffer
+ * @param flags MSG_DONTWAIT or 0
+ * @return see recv()
+ */
+static int peer_recv(int s, struct bsd_socket *sock, void *buffer,
+                     size_t length, int flags)
+{
+    /* datagrams from other sources do not restart SO_RCVTIMEO */
+    uint32_t start = bsd_clock_ms();
+
+    for ( ; /* forever */ ; )
+    {
+        SlSockAddrIn_t from;
+        SlSocklen_t from_len = sizeof(from);
+
+        int result = sl_RecvFrom(s, buffer, length, 0, (SlSockAddr_t*)&from,
+                                 &from_len);
+        if (result < 0)
+        {
+            return bsd_recv_error(result);
+        }
+
+        bsd_rcvbuf_account(s, sock, result, length);
+        if (bsd_socket_peer_match(sock, &from))
+        {
+            return result;
+        }
+
+        /* not from the connected peer, drop it and wait for the next one */
+        if (sock->rcvtimeo && !sock->nonblock && !(flags & MSG_DONTWAIT))
+        {
+            uint32_t elapsed = bsd_clock_ms() - start;
+            if (elapsed >= sock->rcvtimeo)
+            {
                 errno = EAGAIN;
-                break;
+                return -1;
+            }
+
+            SlTimeval_t tv;
+            bsd_ms_to_timeval(&tv, sock->rcvtimeo - elapsed);
+            int ready = bsd_wait_ready(s, 0, &tv);
+            if (ready <= 0)
+            {
+                if (ready == 0)
+                {
+                    errno = EAGAIN;
+                }
+                return -1;
+            }
         }
+        else if (wait_check(s, sock, flags, 0) < 0)
+        {
+            return -1;
+        }
+    }
+}
+
+/*
+ * ::recv()
+ */
+int recv(int s, void *buffer, size_t length, int flags)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock && (sock->shut & BSD_SHUT_RD))
+    {
+        /* shutdown(SHUT_RD), behave as if the peer had closed */
+        return 0;
+    }
+
+    if (sock && sock->rx_demux)
+    {
+        return bsd_async_recv(s, sock, buffer, length, flags, NULL, NULL);
+    }
+
+    if (sock && sock->rx_buf)
+    {
+        return readahead_recv(s, sock, buffer, length, flags);
+    }
+
+    if (flags & MSG_PEEK)
+    {
+        errno = EOPNOTSUPP;
         return -1;
     }
 
+    if (wait_check(s, sock, flags, 0) < 0)
+    {
+        return -1;
+    }
+
+    if (bsd_socket_dgram_peer(sock))
+    {
+        return peer_recv(s, sock, buffer, length, flags);
+    }
+
+    int result = sl_Recv(s, buffer, length, flags & ~MSG_DONTWAIT);
+
+    if (result < 0)
+    {
+        return bsd_recv_error(result);
+    }
+    bsd_rcvbuf_account(s, sock, result, length);
+
+    return result;  
+}
+
+/*
+ * bsd_send_error()
+ */
+int bsd_send_error(int result)
+{
+    switch (result)
+    {
+        default:
+            if (!bsd_conn_error(result))
+            {
+                errno = EINVAL;
+            }
+            break;
+        case SL_POOL_IS_EMPTY:
+            usleep(10000);
+            /* fall through */
+        case SL_EAGAIN:
+            errno = EAGAIN;
+            break;
+    }
+    return -1;
+}
+
+/*
+ * ::send()
+ */
+int send(int s, const void *buffer, size_t length, int flags)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock && (sock->shut & BSD_SHUT_WR))
+    {
+        errno = EPIPE;
+        return -1;
+    }
+
+    if (sock && sock->error)
+    {
+        /* report a failure of previously queued data */
+        unsigned long key = bsd_lock();
+        errno = sock->error;
+        sock->error = 0;
+        bsd_unlock(key);
+        return -1;
+    }
+
+    if (sock && sock->tx_async)
+    {
+        return bsd_async_send(s, buffer, length, flags);
+    }
+
+    if (sock && sock->tx_count)
+    {
+        /* preserve ordering with buffers queued by send_buf() */
+        int pending = bsd_txq_flush(s);
+        if (pending < 0)
+        {
+            return -1;
+        }
+        if (pending > 0)
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+
+    if (wait_check(s, sock, flags, 1) < 0)
+    {
+        return -1;
+    }
+
+    int result = bsd_sl_send(s, sock, buffer, length, flags & ~MSG_DONTWAIT);
+
+    if (result < 0)
+    {
+        return bsd_send_error(result);
+    }
+
+    return result;  
+}
+
+/*
+ * ::sendto()
+ */
+int recvfrom(int s, void *buffer, size_t length, int flags,
+             struct sockaddr *src_addr, socklen_t *addrlen)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock && (sock->shut & BSD_SHUT_RD))
+    {
+        /* shutdown(SHUT_RD), behave as if the peer had closed */
+        return 0;
+    }
+
+    if (sock && sock->rx_demux)
+    {
+        return bsd_async_recv(s, sock, buffer, length, flags, src_addr,
+                              addrlen);
+    }
+
+    if (sock && sock->rx_buf)
+    {
+        /* stream socket, the source address is that of the peer */
+        return readahead_recv(s, sock, buffer, length, flags);
+    }
+
+    if (flags & MSG_PEEK)
+    {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+
+    if (wait_check(s, sock, flags, 0) < 0)
+    {
+        return -1;
+    }
+
+    if (bsd_socket_dgram_peer(sock))
+    {
+        int result = peer_recv(s, sock, buffer, length, flags);
+        if (result >= 0 && src_addr != NULL &&
+            *addrlen >= sizeof(struct sockaddr_in))
+        {
+            struct sockaddr_in *addr_in = (struct sockaddr_in *)src_addr;
+            addr_in->sin_family = AF_INET;
+            addr_in->sin_port = sock->peer.sin_port;
+            addr_in->sin_addr.s_addr = sock->peer.sin_addr.s_addr;
+            *addrlen = sizeof(struct sockaddr_in);
+        }
+        return result;
+    }
+
+    SlSockAddr_t sl_sockaddr;
+    SlSocklen_t sl_addrlen = sizeof(SlSockAddr_t);
+
+    int result = sl_RecvFrom(s, buffer, length, flags & ~MSG_DONTWAIT,
+                             &sl_sockaddr, &sl_addrlen);
+
+    if (result < 0)
+    {
+        /* the source address is not filled in on failure */
+        return bsd_recv_error(result);
+    }
+
+    if (src_addr != NULL)
+    {
+        switch (sl_sockaddr.sa_family)
+        {
+            default:
+                errno = EAFNOSUPPORT;
+                return -1;
+            case SL_AF_INET:
+            {
+                if (sizeof(struct sockaddr_in) < *addrlen)
+                {
+                    break;
+                }
+                struct sockaddr_in *addr_in = (struct sockaddr_in *)src_addr;
+                SlSockAddrIn_t *sl_addr_in = (SlSockAddrIn_t*)&sl_sockaddr;
+
+                addr_in->sin_family = AF_INET;
+                addr_in->sin_port = sl_addr_in->sin_port;
+                addr_in->sin_addr.s_addr = sl_addr_in->sin_addr.s_addr;
+                break;
+            }
+        }
+    }
+
+    bsd_rcvbuf_account(s, sock, result, length);
     return result;
 }
 
@@ -385,6 +1269,12 @@ int sendto(int s, const void *buffer, size_t length, int flags,
     SlSockAddr_t sl_sockaddr;
     SlSockAddr_t *sl_sockaddr_ptr;
 
+    if (bsd_socket_get(s) && (bsd_socket_get(s)->shut & BSD_SHUT_WR))
+    {
+        errno = EPIPE;
+        return -1;
+    }
+
     if (dest_addr != NULL)
     {
         switch (dest_addr->sa_family)
@@ -410,26 +1300,134 @@ int sendto(int s, const void *buffer, size_t length, int flags,
         }
         sl_sockaddr_ptr = &sl_sockaddr;
     }
+    else if (bsd_socket_dgram_peer(bsd_socket_get(s)))
+    {
+        return send(s, buffer, length, flags);
+    }
     else
     {
         sl_sockaddr_ptr = NULL;
         addrlen = 0;
     }
 
-    int result = sl_SendTo(s, buffer, length, flags, sl_sockaddr_ptr, addrlen);
+    if (wait_check(s, bsd_socket_get(s), flags, 1) < 0)
+    {
+        return -1;
+    }
+
+    int result = sl_SendTo(s, buffer, length, flags & ~MSG_DONTWAIT,
+                           sl_sockaddr_ptr, addrlen);
 
     if (result < 0)
     {
-        switch (result)
+        return bsd_send_error(result);
+    }
+
+    return result;
+}
+
+/** Allocate, resize, or free the read-ahead buffer of a socket.
+ * @param s socket descriptor
+ * @param size new buffer size in bytes, 0 to disable read-ahead
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+static int readahead_resize(int s, int size)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (!sock || sock->type != SOCK_STREAM || sock->rx_count != 0 ||
+        sock->rx_demux ||
+        (size != 0 && (size < BSD_READAHEAD_MIN || size > BSD_READAHEAD_MAX)))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (size == sock->rx_size)
+    {
+        return 0;
+    }
+
+    uint8_t *rx_buf = NULL;
+    if (size)
+    {
+        rx_buf = malloc(size);
+        if (rx_buf == NULL)
         {
-            default:
-                errno = EINVAL;
-                break;
+            errno = ENOMEM;
+            return -1;
         }
+    }
+
+    free(sock->rx_buf);
+    sock->rx_buf = rx_buf;
+    sock->rx_size = size;
+    sock->rx_head = 0;
+    return 0;
+}
+
+/*
+ * bsd_set_nonblocking()
+ */
+int bsd_set_nonblocking(int s, int nonblock)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
         return -1;
     }
 
-    return result;
+    nonblock = nonblock ? 1 : 0;
+    if (sock->nonblock == nonblock)
+    {
+        /* no change, skip the network processor */
+        return 0;
+    }
+
+    SlSockNonblocking_t enable;
+    enable.NonblockingEnabled = nonblock;
+    int result = sl_SetSockOpt(s, SL_SOL_SOCKET, SL_SO_NONBLOCKING, &enable,
+                               sizeof(enable));
+    if (result < 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    sock->nonblock = nonblock;
+    return 0;
+}
+
+/** Set or clear one of the cached boolean options of a socket.
+ * @param sock host side socket state
+ * @param flag BSD_OPT_* flag to update
+ * @param option_value option value, non-zero to set
+ * @param option_len length of option_value
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+static int set_flag_option(struct bsd_socket *sock, uint8_t flag,
+                           const void *option_value, socklen_t option_len)
+{
+    if (option_len != sizeof (int))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    unsigned long key = bsd_lock();
+    if (*((int *)option_value))
+    {
+        sock->opts |= flag;
+    }
+    else
+    {
+        sock->opts &= ~flag;
+    }
+    bsd_unlock(key);
+
+    return 0;
 }
 
 /*
@@ -439,6 +1437,13 @@ int setsockopt(int s, int level, int option_name,
                const void *option_value, socklen_t option_len)
 {
     int result;
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
 
     switch (level)
     {
@@ -452,31 +1457,204 @@ int setsockopt(int s, int level, int option_name,
                     errno = EINVAL;
                     return -1;
                 case SO_REUSEADDR:
-                    /* CC32xx does not care about SO_REUSEADDR, ignore it */
-                    result = 0;
-                    break;
+                    /* CC32xx does not care about SO_REUSEADDR, only cache it */
+                    return set_flag_option(sock, BSD_OPT_REUSEADDR,
+                                           option_value, option_len);
                 case SO_BROADCAST:
-                    /* CC32xx does not care about SO_BROADCAST, ignore it */
-                    result = 0;
-                    break;
+                    /* CC32xx does not care about SO_BROADCAST, only cache it */
+                    return set_flag_option(sock, BSD_OPT_BROADCAST,
+                                           option_value, option_len);
                 case SO_RCVBUF:
                     if (option_len != sizeof (int))
                     {
                         errno = EINVAL;
                         return -1;
                     }
+                {
+                    /* setting SO_RCVBUF turns auto-tuning off */
+                    unsigned long key = bsd_lock();
+                    sock->opts &= ~BSD_OPT_RCVBUFAUTO;
+                    int same = (sock->opts & BSD_OPT_RCVBUF) &&
+                               sock->rcvbuf == *((uint32_t *)option_value);
+                    bsd_unlock(key);
+                    if (same)
+                    {
+                        /* no change, skip the network processor */
+                        result = 0;
+                    }
                     else
                     {
                         SlSockWinsize_t size;
                         size.WinSize = *((int *)option_value);
                         result = sl_SetSockOpt(s, SL_SOL_SOCKET, SL_SO_RCVBUF,
                                                &size, sizeof(size));
+                        if (result >= 0)
+                        {
+                            key = bsd_lock();
+                            sock->rcvbuf = size.WinSize;
+                            sock->opts |= BSD_OPT_RCVBUF;
+                            bsd_unlock(key);
+                        }
+                    }
+                    break;
+                }
+                case SO_SNDBUF:
+                    /* CC32xx does not care about SO_SNDBUF, only cache it */
+                    if (option_len != sizeof (int))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    sock->sndbuf = *((int *)option_value);
+                    result = 0;
+                    break;
+                case SO_RCVTIMEO:
+                {
+                    if (option_len != sizeof (struct timeval))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    const struct timeval *tv = option_value;
+                    uint32_t ms = tv->tv_sec * 1000 + tv->tv_usec / 1000;
+                    if (ms == 0 && (tv->tv_sec || tv->tv_usec))
+                    {
+                        /* round up rather than disabling the timeout */
+                        ms = 1;
+                    }
+                    if (ms == sock->rcvtimeo)
+                    {
+                        /* no change, skip the network processor */
+                        return 0;
+                    }
+                    /* the network processor enforces it for receive */
+                    SlTimeval_t sl_tv;
+                    bsd_ms_to_timeval(&sl_tv, ms);
+                    result = sl_SetSockOpt(s, SL_SOL_SOCKET, SL_SO_RCVTIMEO,
+                                           &sl_tv, sizeof(sl_tv));
+                    if (result >= 0)
+                    {
+                        sock->rcvtimeo = ms;
+                    }
+                    break;
+                }
+                case SO_SNDTIMEO:
+                {
+                    if (option_len != sizeof (struct timeval))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    /* enforced on the host, SimpleLink has no send timeout */
+                    const struct timeval *tv = option_value;
+                    sock->sndtimeo = tv->tv_sec * 1000 + tv->tv_usec / 1000;
+                    if (sock->sndtimeo == 0 && (tv->tv_sec || tv->tv_usec))
+                    {
+                        sock->sndtimeo = 1;
+                    }
+                    result = 0;
+                    break;
+                }
+                case SO_KEEPALIVE:
+                {
+                    if (option_len != sizeof (int))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    uint8_t keepalive = *((int *)option_value) ? 1 : 0;
+                    if (keepalive == sock->keepalive)
+                    {
+                        /* no change, skip the network processor */
+                        return 0;
+                    }
+                    SlSockKeepalive_t sl_keepalive;
+                    sl_keepalive.KeepaliveEnabled = keepalive;
+                    result = sl_SetSockOpt(s, SL_SOL_SOCKET, SL_SO_KEEPALIVE,
+                                           &sl_keepalive,
+                                           sizeof(sl_keepalive));
+                    if (result >= 0)
+                    {
+                        sock->keepalive = keepalive;
+                    }
+                    break;
+                }
+                case SO_LINGER:
+                {
+                    if (option_len != sizeof (struct linger))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    const struct linger *l = option_value;
+                    if (l->l_linger < 0 || l->l_linger > UINT16_MAX)
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+#if defined(SL_SO_LINGER)
+                    /* a zero timeout makes sl_Close() reset the connection */
+                    SlSocklinger_t sl_linger;
+                    sl_linger.l_onoff = l->l_onoff;
+                    sl_linger.l_linger = l->l_linger;
+                    result = sl_SetSockOpt(s, SL_SOL_SOCKET, SL_SO_LINGER,
+                                           &sl_linger, sizeof(sl_linger));
+                    if (result < 0)
+                    {
+                        break;
+                    }
+#endif
+                    /* also bounds how long close() drains SO_ASYNCSEND */
+                    sock->linger = l->l_linger;
+                    if (l->l_onoff)
+                    {
+                        sock->opts |= BSD_OPT_LINGER;
+                    }
+                    else
+                    {
+                        sock->opts &= ~BSD_OPT_LINGER;
+                    }
+                    result = 0;
+                    break;
+                }
+                case SO_READAHEAD:
+                    if (option_len != sizeof (int))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    return readahead_resize(s, *((int *)option_value));
+                case SO_RCVBUFAUTO:
+                    if (option_len != sizeof (int))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    return bsd_rcvbuf_auto(s, *((int *)option_value));
+                case SO_RXDEMUX:
+                    if (option_len != sizeof (int))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    return bsd_async_recv_start(s, *((int *)option_value));
+                case SO_ASYNCSEND:
+                {
+                    if (option_len != sizeof (int))
+                    {
+                        errno = EINVAL;
+                        return -1;
                     }
-                    break;
-                case SO_SNDBUF:
-                    /* CC32xx does not care about SO_SNDBUF, ignore it */
+                    if (*((int *)option_value) &&
+                        bsd_async_send_start() < 0)
+                    {
+                        return -1;
+                    }
+                    /* once cleared, send() flushes whatever is left */
+                    sock->tx_async = *((int *)option_value) ? 1 : 0;
                     result = 0;
                     break;
+                }
             }
             break;
         case IPPROTO_TCP:
@@ -486,9 +1664,41 @@ int setsockopt(int s, int level, int option_name,
                     errno = EINVAL;
                     return -1;
                 case TCP_NODELAY:
-                    /* CC32xx does not care about Nagel algorithm, ignore it */
-                    result = 0;
+                    /* CC32xx does not care about Nagel algorithm, only cache
+                     * it
+                     */
+                    return set_flag_option(sock, BSD_OPT_NODELAY,
+                                           option_value, option_len);
+                case TCP_KEEPIDLE:
+                {
+                    if (option_len != sizeof (int) ||
+                        *((int *)option_value) <= 0 ||
+                        *((int *)option_value) > UINT16_MAX)
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+#if defined(SL_SO_KEEPALIVETIME)
+                    if (sock->keepidle == *((int *)option_value))
+                    {
+                        /* no change, skip the network processor */
+                        return 0;
+                    }
+                    _u32 seconds = *((int *)option_value);
+                    result = sl_SetSockOpt(s, SL_SOL_SOCKET,
+                                           SL_SO_KEEPALIVETIME, &seconds,
+                                           sizeof(seconds));
+                    if (result >= 0)
+                    {
+                        sock->keepidle = seconds;
+                    }
                     break;
+#else
+                    /* this SimpleLink SDK has a fixed keepalive time */
+                    errno = ENOPROTOOPT;
+                    return -1;
+#endif
+                }
             }
             break;
     }
@@ -507,13 +1717,63 @@ int setsockopt(int s, int level, int option_name,
     return result;
 }
 
+/** Return an integer socket option value.
+ * @param option_value destination of the option value
+ * @param option_len on input the size of option_value, on output the size
+ *                   of the option value
+ * @param value value to return
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+static int get_int_option(void *option_value, socklen_t *option_len,
+                          int value)
+{
+    if (*option_len < sizeof(int))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    *((int *)option_value) = value;
+    *option_len = sizeof(int);
+    return 0;
+}
+
+/** Return a timeout socket option value.
+ * @param option_value destination of the option value
+ * @param option_len on input the size of option_value, on output the size
+ *                   of the option value
+ * @param ms timeout in milliseconds
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+static int get_timeval_option(void *option_value, socklen_t *option_len,
+                              uint32_t ms)
+{
+    if (*option_len < sizeof(struct timeval))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct timeval *tv = option_value;
+    tv->tv_sec = ms / 1000;
+    tv->tv_usec = (ms % 1000) * 1000;
+    *option_len = sizeof(struct timeval);
+    return 0;
+}
+
 /*
  * ::getsockopt()
  */
 int getsockopt(int socket, int level, int option_name,
                void *option_value, socklen_t *option_len)
 {
-    int result;
+    struct bsd_socket *sock = bsd_socket_get(socket);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
 
     switch (level)
     {
@@ -521,22 +1781,92 @@ int getsockopt(int socket, int level, int option_name,
             errno = EINVAL;
             return -1;
         case SOL_SOCKET:
-            level = SL_SOL_SOCKET;
             switch (option_name)
             {
                 default:
                     errno = EINVAL;
                     return -1;
+                case SO_TYPE:
+                    return get_int_option(option_value, option_len,
+                                          sock->type);
                 case SO_REUSEADDR:
-                {
                     /* CC32xx does not care about SO_REUSEADDR,
                      * we assume it is on by default
                      */
-                    int *so_reuseaddr = (int *)(option_value);
-                    *so_reuseaddr = 1;
-                    *option_len = sizeof(int);
-                    result = 0;
-                    break;
+                    return get_int_option(option_value, option_len,
+                                          !!(sock->opts & BSD_OPT_REUSEADDR));
+                case SO_BROADCAST:
+                    return get_int_option(option_value, option_len,
+                                          !!(sock->opts & BSD_OPT_BROADCAST));
+                case SO_RCVBUF:
+                    if (!(sock->opts & BSD_OPT_RCVBUF))
+                    {
+                        /* ask the network processor only once */
+                        SlSockWinsize_t size;
+                        SlSocklen_t size_len = sizeof(size);
+                        int result = sl_GetSockOpt(socket, SL_SOL_SOCKET,
+                                                   SL_SO_RCVBUF, &size,
+                                                   &size_len);
+                        if (result < 0)
+                        {
+                            errno = EINVAL;
+                            return -1;
+                        }
+                        unsigned long key = bsd_lock();
+                        if (!(sock->opts & BSD_OPT_RCVBUF))
+                        {
+                            /* unless the window changed meanwhile */
+                            sock->rcvbuf = size.WinSize;
+                            sock->opts |= BSD_OPT_RCVBUF;
+                        }
+                        bsd_unlock(key);
+                    }
+                    return get_int_option(option_value, option_len,
+                                          sock->rcvbuf);
+                case SO_SNDBUF:
+                    return get_int_option(option_value, option_len,
+                                          sock->sndbuf);
+                case SO_KEEPALIVE:
+                    return get_int_option(option_value, option_len,
+                                          sock->keepalive);
+                case SO_LINGER:
+                {
+                    if (*option_len < sizeof(struct linger))
+                    {
+                        errno = EINVAL;
+                        return -1;
+                    }
+                    struct linger *l = option_value;
+                    l->l_onoff = !!(sock->opts & BSD_OPT_LINGER);
+                    l->l_linger = sock->linger;
+                    *option_len = sizeof(struct linger);
+                    return 0;
+                }
+                case SO_RCVTIMEO:
+                    return get_timeval_option(option_value, option_len,
+                                              sock->rcvtimeo);
+                case SO_SNDTIMEO:
+                    return get_timeval_option(option_value, option_len,
+                                              sock->sndtimeo);
+                case SO_READAHEAD:
+                    return get_int_option(option_value, option_len,
+                                          sock->rx_demux ? 0 : sock->rx_size);
+                case SO_RCVBUFAUTO:
+                    return get_int_option(option_value, option_len,
+                                          !!(sock->opts & BSD_OPT_RCVBUFAUTO));
+                case SO_RXDEMUX:
+                    return get_int_option(option_value, option_len,
+                                          sock->rx_demux ? sock->rx_size : 0);
+                case SO_ASYNCSEND:
+                    return get_int_option(option_value, option_len,
+                                          sock->tx_async);
+                case SO_ERROR:
+                {
+                    unsigned long key = bsd_lock();
+                    int error = sock->error;
+                    sock->error = 0;
+                    bsd_unlock(key);
+                    return get_int_option(option_value, option_len, error);
                 }
             }
             break;
@@ -547,32 +1877,164 @@ int getsockopt(int socket, int level, int option_name,
                     errno = EINVAL;
                     return -1;
                 case TCP_NODELAY:
-                {
                     /* CC32xx does not care about Nagel algorithm,
                      * we assume it is off by default
                      */
-                    int *tcp_nodelay = (int *)(option_value);
-                    *tcp_nodelay = 1;
-                    *option_len = sizeof(int);
-                    result = 0;
-                    break;
-                }
+                    return get_int_option(option_value, option_len,
+                                          !!(sock->opts & BSD_OPT_NODELAY));
+                case TCP_KEEPIDLE:
+                    return get_int_option(option_value, option_len,
+                                          sock->keepidle ? sock->keepidle :
+                                          BSD_KEEPIDLE_DEFAULT);
             }
             break;
     }
 
-    if (result < 0)
+    return 0;
+}
+
+/** Let the send thread finish transmitting what was queued on a socket
+ * about to be closed, for at most the SO_LINGER timeout if one is set, else
+ * the SO_SNDTIMEO timeout if one is set, else BSD_CLOSE_DRAIN_MS.  Whatever
+ * is left is discarded by the caller.
+ * @param sock host side socket state
+ */
+static void close_drain(struct bsd_socket *sock)
+{
+    uint32_t timeout = BSD_CLOSE_DRAIN_MS;
+
+    if (sock->opts & BSD_OPT_LINGER)
     {
-        switch (result)
+        /* a zero timeout discards it for a fast abortive close */
+        timeout = sock->linger * 1000UL;
+    }
+    else if (sock->sndtimeo)
+    {
+        timeout = sock->sndtimeo;
+    }
+
+    if (sock->tx_async && timeout)
+    {
+        uint32_t start = bsd_clock_ms();
+        while (sock->tx_count && !sock->error &&
+               bsd_clock_ms() - start < timeout)
         {
-            default:
-                errno = EINVAL;
-                break;
+            bsd_async_send_wake();
+            usleep(10000);
         }
+    }
+}
+
+/*
+ * ::shutdown()
+ */
+int shutdown(int s, int how)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
         return -1;
     }
 
-    return result;
+    uint8_t shut;
+    switch (how)
+    {
+        default:
+            errno = EINVAL;
+            return -1;
+        case SHUT_RD:
+            shut = BSD_SHUT_RD;
+            break;
+        case SHUT_WR:
+            shut = BSD_SHUT_WR;
+            break;
+        case SHUT_RDWR:
+            shut = BSD_SHUT_RD | BSD_SHUT_WR;
+            break;
+    }
+
+    if (sock->type == SOCK_STREAM && !(sock->opts & BSD_OPT_PEER))
+    {
+        errno = ENOTCONN;
+        return -1;
+    }
+
+    if (shut == BSD_SHUT_WR && sock->type == SOCK_STREAM)
+    {
+        /* SimpleLink cannot send a FIN without closing both directions */
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+
+    unsigned long key = bsd_lock();
+    if (sock->shut & BSD_SHUT_CLOSED)
+    {
+        bsd_unlock(key);
+        return 0;
+    }
+    sock->shut |= shut;
+    if ((shut & BSD_SHUT_RD) && !sock->rx_filling)
+    {
+        /* discard whatever has already been received, a fill in progress
+         * does so itself once it sees BSD_SHUT_RD, as its tail would not
+         * survive the count changing under it
+         */
+        sock->rx_count = 0;
+    }
+    if ((shut & BSD_SHUT_RD) && sock->rx_demux)
+    {
+        /* blocked readers return 0 */
+        sock->rx_eof = 1;
+    }
+    bsd_unlock(key);
+
+    if (shut & BSD_SHUT_RD)
+    {
+        if (sock->rx_sem)
+        {
+            osi_SyncObjSignal(&sock->rx_sem);
+        }
+        /* select() waiting on the receive queue sees it readable now */
+        bsd_select_kick();
+    }
+
+    if (shut != (BSD_SHUT_RD | BSD_SHUT_WR))
+    {
+        /* done on the host, data still queued for transmission is sent */
+        return 0;
+    }
+
+    /* SimpleLink can only close both directions at once, which frees the
+     * network processor socket right away.  The descriptor stays reserved
+     * until close().
+     */
+    close_drain(sock);
+
+    key = bsd_lock();
+    sock->shut |= BSD_SHUT_CLOSED;
+    sock->rx_demux = 0;
+    bsd_unlock(key);
+
+    int result = sl_Close(s);
+    if (result < 0)
+    {
+        key = bsd_lock();
+        sock->shut &= ~BSD_SHUT_CLOSED;
+        bsd_unlock(key);
+        errno = EBADF;
+        return -1;
+    }
+
+    /* a thread draining the transmit queue fails quickly now */
+    while (sock->tx_busy || sock->rx_busy)
+    {
+        usleep(1000);
+    }
+    bsd_txq_purge(sock);
+
+    return 0;
 }
 
 /*
@@ -584,7 +2046,22 @@ int close(int s)
 int _close_r(struct _reent *reent, int s)
 #endif
 {
-    int result = sl_Close(s);
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock)
+    {
+        close_drain(sock);
+    }
+
+    bsd_connpool_closed(s);
+
+    int result = 0;
+    if (socket_state_closing(s))
+    {
+        result = sl_Close(s);
+    }
+
+    socket_state_close(s);
 
     if (result < 0)
     {
@@ -600,54 +2077,104 @@ int _close_r(struct _reent *reent, int s)
     return 0;
 }
 
+/** Layout of the caller's buffer used by gethostbyname_r(). */
+struct hostent_data
+{
+    struct in_addr addr;      /**< the address */
+    char *addr_list[2];       /**< h_addr_list */
+    char *aliases[1];         /**< h_aliases */
+    char name[];              /**< h_name */
+};
+
 /*
- * ::gethostbyname()
+ * ::gethostbyname_r()
  */
-struct hostent *gethostbyname(const char *name)
+int gethostbyname_r(const char *name, struct hostent *ret, char *buf,
+                    size_t buflen, struct hostent **result, int *h_errnop)
 {
-    static struct hostent he;
-    static struct in_addr ia;
-    static struct in_addr *ia_list[2];
-    static char *alias_list[1];
+    size_t pad = (-(uintptr_t)buf) & (sizeof(void*) - 1);
+    size_t name_len = strlen(name) + 1;
+
+    *result = NULL;
+
+    if (buflen < pad + sizeof(struct hostent_data) + name_len)
+    {
+        *h_errnop = NETDB_INTERNAL;
+        return ERANGE;
+    }
+
     unsigned long ip;
+    uint32_t literal;
+    int error = 0;
 
-    int result = sl_NetAppDnsGetHostByName((int8_t*)name, strlen(name), &ip,
-                                           SL_AF_INET);
+    if (bsd_inet_parse4(name, &literal))
+    {
+        /* dotted decimal, no need to ask DNS */
+        ip = ntohl(literal);
+    }
+    else
+    {
+        error = bsd_dns_lookup(name, SL_AF_INET, &ip);
+    }
 
-    if (result < 0)
+    if (error < 0)
     {
-        switch (result)
+        switch (error)
         {
             default:
-                h_errno = NO_RECOVERY;
+                *h_errnop = NO_RECOVERY;
                 break;
             case SL_NET_APP_DNS_MALFORMED_PACKET:
             case SL_NET_APP_DNS_MISMATCHED_RESPONSE:
             case SL_POOL_IS_EMPTY:
-                h_errno = TRY_AGAIN;
+                *h_errnop = TRY_AGAIN;
                 break;
             case SL_NET_APP_DNS_QUERY_NO_RESPONSE:
             case SL_NET_APP_DNS_NO_SERVER:
             case SL_NET_APP_DNS_QUERY_FAILED:
-                h_errno = HOST_NOT_FOUND;
+                *h_errnop = HOST_NOT_FOUND;
                 break;
         }
-        return NULL;
+        return 0;
     }
 
-    alias_list[0] = NULL;
+    struct hostent_data *data = (struct hostent_data*)(buf + pad);
+
+    data->addr.s_addr = htonl(ip);
+    data->addr_list[0] = (char*)&data->addr;
+    data->addr_list[1] = NULL;
+    data->aliases[0] = NULL;
+    memcpy(data->name, name, name_len);
 
-    ia.s_addr = ip;
-    ia_list[0] = &ia;
-    ia_list[1] = NULL;
+    ret->h_name = data->name;
+    ret->h_aliases = data->aliases;
+    ret->h_addrtype = AF_INET;
+    ret->h_length = 4;
+    ret->h_addr_list = data->addr_list;
 
-    he.h_name = (char*)name;
-    he.h_aliases = alias_list;
-    he.h_addrtype = AF_INET;
-    he.h_length = 4;
-    he.h_addr_list = (char**)ia_list;
+    *result = ret;
+    return 0;
+}
+
+/*
+ * ::gethostbyname()
+ */
+struct hostent *gethostbyname(const char *name)
+{
+    static struct hostent he;
+    static void *buf[(sizeof(struct hostent_data) + BSD_HOST_NAME_MAX + 1 +
+                      sizeof(void*) - 1) / sizeof(void*)];
+    struct hostent *result;
+
+    int error = gethostbyname_r(name, &he, (char*)buf, sizeof(buf), &result,
+                                &h_errno);
+    if (error == ERANGE)
+    {
+        /* name longer than any valid host name */
+        h_errno = HOST_NOT_FOUND;
+    }
 
-    return &he;
+    return result;
 }
 
 /*
@@ -665,6 +2192,14 @@ const char *gai_strerror (int ecode)
             return "non-recoverable failure";
         case EAI_MEMORY:
             return "memory allocation failure";
+        case EAI_FAMILY:
+            return "address family not supported";
+        case EAI_SOCKTYPE:
+            return "socket type not supported";
+        case EAI_NONAME:
+            return "name or service not known";
+        case EAI_SERVICE:
+            return "service not supported";
     }
 }
 
@@ -673,98 +2208,176 @@ const char *gai_strerror (int ecode)
  */
 void freeaddrinfo(struct addrinfo *ai)
 {
-    free(ai->ai_addr);
+    /* the whole chain is one allocation */
     free(ai);
 }
 
 /*
- * ::getaddrinfo
+ * bsd_addrinfo_build()
  */
-int getaddrinfo(const char *nodename, const char *servname,
-                const struct addrinfo *hints,
-                struct addrinfo **res)
+int bsd_addrinfo_build(const char *canonname, uint32_t addr, uint16_t port,
+                       const struct addrinfo *hints, struct addrinfo **res)
 {
-    unsigned long ip_addr;
-    uint8_t domain;
+    /* socket types returned when the hints leave it open */
+    static const struct
+    {
+        int socktype;
+        int protocol;
+    } fanout[] =
+    {
+        {SOCK_STREAM, IPPROTO_TCP},
+        {SOCK_DGRAM, IPPROTO_UDP},
+    };
+
+    int flags = hints ? hints->ai_flags : 0;
+    int socktype = hints ? hints->ai_socktype : 0;
+    int count;
 
-    *res = malloc(sizeof(struct addrinfo));
-    if (*res == NULL)
+    switch (socktype)
     {
-        return EAI_MEMORY;
+        default:
+            return EAI_SOCKTYPE;
+        case 0:
+            count = sizeof(fanout) / sizeof(fanout[0]);
+            break;
+        case SOCK_STREAM:
+        case SOCK_DGRAM:
+        case SOCK_RAW:
+            count = 1;
+            break;
     }
-    memset(*res, 0, sizeof(struct addrinfo));
 
-    (*res)->ai_addr = malloc(sizeof(struct sockaddr));
-    if ((*res)->ai_addr == NULL)
+    size_t canon_len = 0;
+    if ((flags & AI_CANONNAME) && canonname)
+    {
+        canon_len = strlen(canonname) + 1;
+    }
+
+    /* entries, then their addresses, then the canonical name */
+    size_t size = count * (sizeof(struct addrinfo) +
+                           sizeof(struct sockaddr_in)) + canon_len;
+    struct addrinfo *ai = malloc(size);
+    if (ai == NULL)
     {
-        free(*res);
         return EAI_MEMORY;
     }
-    memset((*res)->ai_addr, 0, sizeof(struct addrinfo));
+    struct sockaddr_in *addr_in = (struct sockaddr_in*)(ai + count);
+    memset(ai, 0, size - canon_len);
 
-    switch (hints->ai_family)
+    for (int i = 0; i < count; ++i)
     {
-        case AF_INET:
-            domain = SL_AF_INET;
-            break;
-        case AF_INET6:
-            domain = SL_AF_INET6;
-            break;
-        case AF_PACKET:
-            domain = SL_AF_PACKET;
-            break;
-        default:
-            errno = EAFNOSUPPORT;
-            free((*res)->ai_addr);
-            free(*res);
-            return -1;
+        ai[i].ai_flags = flags;
+        ai[i].ai_family = AF_INET;
+        ai[i].ai_socktype = socktype ? socktype : fanout[i].socktype;
+        ai[i].ai_protocol = socktype ? hints->ai_protocol :
+                                       fanout[i].protocol;
+        ai[i].ai_addrlen = sizeof(struct sockaddr_in);
+        ai[i].ai_addr = (struct sockaddr*)&addr_in[i];
+        ai[i].ai_next = (i + 1) < count ? &ai[i + 1] : NULL;
+        addr_in[i].sin_family = AF_INET;
+        addr_in[i].sin_port = port;
+        addr_in[i].sin_addr.s_addr = addr;
     }
 
-    int result = sl_NetAppDnsGetHostByName((int8_t*)nodename, strlen(nodename),
-                                           &ip_addr, domain);
+    if (canon_len)
+    {
+        ai[0].ai_canonname = (char*)(addr_in + count);
+        memcpy(ai[0].ai_canonname, canonname, canon_len);
+    }
+
+    *res = ai;
+    return 0;
+}
+
+/** Parse a decimal port number.
+ * @param servname text to parse
+ * @param port parsed port, network byte order
+ * @return 1 on success, 0 if servname is not a decimal port number
+ */
+static int parse_port(const char *servname, uint16_t *port)
+{
+    uint32_t value = 0;
 
-    if (result != 0)
+    if (*servname == '\0')
     {
-        free((*res)->ai_addr);
-        free(*res);
-        switch (result)
+        return 0;
+    }
+    do
+    {
+        if (*servname < '0' || *servname > '9')
         {
-            default:
-            case SL_POOL_IS_EMPTY:
-                return EAI_AGAIN;
-            case SL_NET_APP_DNS_QUERY_NO_RESPONSE:
-            case SL_NET_APP_DNS_NO_SERVER:
-            case SL_NET_APP_DNS_QUERY_FAILED:
-            case SL_NET_APP_DNS_MALFORMED_PACKET:
-            case SL_NET_APP_DNS_MISMATCHED_RESPONSE:
-                return EAI_FAIL;
+            return 0;
+        }
+        value = value * 10 + (*servname - '0');
+        if (value > UINT16_MAX)
+        {
+            return 0;
         }
+    } while (*++servname);
+
+    *port = htons(value);
+    return 1;
+}
+
+/*
+ * ::getaddrinfo
+ */
+int getaddrinfo(const char *nodename, const char *servname,
+                const struct addrinfo *hints,
+                struct addrinfo **res)
+{
+    int flags = hints ? hints->ai_flags : 0;
+
+    if (hints && hints->ai_family != AF_UNSPEC && hints->ai_family != AF_INET)
+    {
+        /* only IPv4 is supported */
+        return EAI_FAMILY;
     }
 
-    switch (hints->ai_family)
+    if (nodename == NULL && servname == NULL)
     {
-        case AF_INET:
+        return EAI_NONAME;
+    }
+
+    uint16_t port = 0;
+    if (servname && !parse_port(servname, &port))
+    {
+        /* there is no services database to look names up in */
+        return (flags & AI_NUMERICSERV) ? EAI_NONAME : EAI_SERVICE;
+    }
+
+    uint32_t addr;
+    if (nodename == NULL)
+    {
+        addr = htonl((flags & AI_PASSIVE) ? INADDR_ANY : INADDR_LOOPBACK);
+    }
+    else if (!bsd_inet_parse4(nodename, &addr))
+    {
+        if (flags & AI_NUMERICHOST)
         {
-            struct sockaddr_in *addr_in = (struct sockaddr_in*)(*res)->ai_addr;
-            (*res)->ai_flags = 0;
-            (*res)->ai_family = hints->ai_family;
-            (*res)->ai_socktype = hints->ai_socktype;
-            (*res)->ai_protocol = hints->ai_protocol;
-            (*res)->ai_addrlen = sizeof(struct sockaddr_in);
-            addr_in->sin_family = hints->ai_family;
-            addr_in->sin_port = htons((uint16_t)strtol(servname, NULL, 0));
-            addr_in->sin_addr.s_addr = htonl(ip_addr);
-            break;
+            return EAI_NONAME;
         }
-        case AF_INET6:
-        case AF_PACKET:
-        default:
-            errno = EAFNOSUPPORT;
-            free((*res)->ai_addr);
-            free(*res);
-            return -1;
+
+        unsigned long ip_addr;
+        int result = bsd_dns_lookup(nodename, SL_AF_INET, &ip_addr);
+
+        if (result != 0)
+        {
+            switch (result)
+            {
+                default:
+                case SL_POOL_IS_EMPTY:
+                    return EAI_AGAIN;
+                case SL_NET_APP_DNS_QUERY_NO_RESPONSE:
+                case SL_NET_APP_DNS_NO_SERVER:
+                case SL_NET_APP_DNS_QUERY_FAILED:
+                case SL_NET_APP_DNS_MALFORMED_PACKET:
+                case SL_NET_APP_DNS_MISMATCHED_RESPONSE:
+                    return EAI_FAIL;
+            }
+        }
+        addr = htonl(ip_addr);
     }
 
-    return 0;
+    return bsd_addrinfo_build(nodename, addr, port, hints, res);
 }
-
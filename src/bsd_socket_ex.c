@@ -0,0 +1,197 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_socket_ex.c
+ * This file implements batched socket creation and configuration.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** Largest number of options a socket template may carry, one bit each in
+ * socket_template::sl::skip.
+ */
+#define TEMPLATE_OPTIONS_MAX (32)
+
+/** Test if setting an option on a newly created socket would not change
+ * anything.
+ * @param option option to test
+ * @return non-zero if the option may be skipped
+ */
+static int option_is_default(const struct sockopt *option)
+{
+    if (option->len != sizeof(int))
+    {
+        /* timeouts and the like, let setsockopt() deal with them */
+        return 0;
+    }
+
+    int value = *((const int *)option->value);
+
+    switch (option->level)
+    {
+        default:
+            return 0;
+        case SOL_SOCKET:
+            switch (option->name)
+            {
+                default:
+                    return 0;
+                case SO_REUSEADDR:
+                    /* assumed on by default */
+                    return value != 0;
+                case SO_BROADCAST:
+                case SO_READAHEAD:
+                case SO_ASYNCSEND:
+                case SO_RCVBUFAUTO:
+                    return value == 0;
+            }
+        case IPPROTO_TCP:
+            /* TCP_NODELAY is assumed on by default */
+            return option->name == TCP_NODELAY && value != 0;
+    }
+}
+
+/*
+ * ::setsockopts()
+ */
+int setsockopts(int s, const struct sockopt *options, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (setsockopt(s, options[i].level, options[i].name,
+                       options[i].value, options[i].len) < 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * ::socket_template_init()
+ */
+int socket_template_init(struct socket_template *tmpl)
+{
+    int domain = tmpl->domain;
+    int type = tmpl->type;
+    int protocol = tmpl->protocol;
+
+    /* stays invalid if initialization fails */
+    tmpl->sl.magic = 0;
+
+    if (tmpl->option_count < 0 ||
+        tmpl->option_count > TEMPLATE_OPTIONS_MAX ||
+        (tmpl->option_count && tmpl->options == NULL))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (bsd_socket_translate(&domain, &type, &protocol) < 0)
+    {
+        return -1;
+    }
+
+    if (tmpl->address &&
+        bsd_sockaddr_translate(tmpl->address,
+                               (SlSockAddr_t*)&tmpl->sl.address) < 0)
+    {
+        return -1;
+    }
+
+    tmpl->sl.skip = 0;
+    for (int i = 0; i < tmpl->option_count; ++i)
+    {
+        if (option_is_default(&tmpl->options[i]))
+        {
+            tmpl->sl.skip |= 1UL << i;
+        }
+    }
+
+    tmpl->sl.domain = domain;
+    tmpl->sl.type = type;
+    tmpl->sl.protocol = protocol;
+    tmpl->sl.reserved = 0;
+    tmpl->sl.magic = SOCKET_TEMPLATE_MAGIC;
+    return 0;
+}
+
+/*
+ * ::socket_ex()
+ */
+int socket_ex(const struct socket_template *tmpl)
+{
+    if (tmpl->sl.magic != SOCKET_TEMPLATE_MAGIC)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int s = bsd_socket_open(tmpl->sl.domain, tmpl->sl.type,
+                            tmpl->sl.protocol, tmpl->type);
+    if (s < 0)
+    {
+        return -1;
+    }
+
+    int result = 0;
+    for (int i = 0; result == 0 && i < tmpl->option_count; ++i)
+    {
+        if (!(tmpl->sl.skip & (1UL << i)))
+        {
+            const struct sockopt *option = &tmpl->options[i];
+            result = setsockopt(s, option->level, option->name,
+                                option->value, option->len);
+        }
+    }
+
+    if (result == 0 && tmpl->address)
+    {
+        result = bsd_bind(s, (const SlSockAddr_t*)&tmpl->sl.address,
+                          tmpl->address_len);
+    }
+
+    if (result < 0)
+    {
+        int error = errno;
+        close(s);
+        errno = error;
+        return -1;
+    }
+
+    return s;
+}
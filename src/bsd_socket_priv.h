@@ -0,0 +1,813 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_socket_priv.h
+ * This file contains the host side per-socket state shared between the BSD
+ * wrapper implementation files.  It is not part of the public interface.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#ifndef _BSD_SOCKET_PRIV_H_
+#define _BSD_SOCKET_PRIV_H_
+
+#include <errno.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <netdb.h>
+
+/* This is very nasty and polutes our namespace.  However, we have little
+ * choice given the current SimpleLink Header structure.
+ */
+#include "socket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Smallest read-ahead buffer that may be configured with SO_READAHEAD. */
+#define BSD_READAHEAD_MIN   (16)
+
+/** Largest read-ahead buffer that may be configured with SO_READAHEAD, this
+ * is bounded by the 16-bit length argument of sl_Recv().
+ */
+#define BSD_READAHEAD_MAX   (8192)
+
+#ifndef BSD_ZC_BLOCK_COUNT
+/** Number of buffers in the recv_zc() pool, at most 32. */
+#define BSD_ZC_BLOCK_COUNT  (4)
+#endif
+
+#ifndef BSD_ZC_BLOCK_SIZE
+/** Size in bytes of each buffer in the recv_zc() pool. */
+#define BSD_ZC_BLOCK_SIZE   (1460)
+#endif
+
+#ifndef BSD_TXQ_DEPTH
+/** Number of transmit buffers that may be queued on one socket. */
+#define BSD_TXQ_DEPTH       (8)
+#endif
+
+#ifndef BSD_ASYNC_SEND_STACK_SIZE
+/** Stack size in bytes of the asynchronous send thread. */
+#define BSD_ASYNC_SEND_STACK_SIZE (2048)
+#endif
+
+#ifndef BSD_ASYNC_SEND_PRIORITY
+/** Priority of the asynchronous send thread. */
+#define BSD_ASYNC_SEND_PRIORITY   (1)
+#endif
+
+#ifndef BSD_CLOSE_DRAIN_MS
+/** Longest time in milliseconds close() waits for the send thread to
+ * transmit what is queued on an SO_ASYNCSEND socket, unless SO_LINGER or
+ * SO_SNDTIMEO give another bound.  Data still queued then is discarded.
+ */
+#define BSD_CLOSE_DRAIN_MS        (5000)
+#endif
+
+#ifndef BSD_SELECT_STACK_SIZE
+/** Stack size in bytes of the select thread. */
+#define BSD_SELECT_STACK_SIZE (2048)
+#endif
+
+#ifndef BSD_SELECT_PRIORITY
+/** Priority of the select thread. */
+#define BSD_SELECT_PRIORITY   (1)
+#endif
+
+#ifndef BSD_SELECT_WAKE_PORT
+/** Loopback UDP port the select thread binds to so that a thread starting
+ * to wait can interrupt the pending sl_Select().
+ */
+#define BSD_SELECT_WAKE_PORT  (49151)
+#endif
+
+#ifndef BSD_SELECT_POLL_MS
+/** Longest time in milliseconds the select thread blocks in sl_Select()
+ * when the loopback socket can not be opened, and so newly registered work
+ * can not interrupt it.
+ */
+#define BSD_SELECT_POLL_MS    (50)
+#endif
+
+/** Largest datagram queued by the select thread. */
+#define BSD_RX_DGRAM_MAX    (1472)
+
+#ifndef BSD_RCVBUF_AUTO_MIN
+/** Smallest receive window chosen by SO_RCVBUFAUTO, also the initial one. */
+#define BSD_RCVBUF_AUTO_MIN       (2048)
+#endif
+
+#ifndef BSD_RCVBUF_AUTO_MAX
+/** Largest receive window chosen by SO_RCVBUFAUTO. */
+#define BSD_RCVBUF_AUTO_MAX       (16384)
+#endif
+
+#ifndef BSD_RCVBUF_AUTO_PERIOD_MS
+/** Shortest time in milliseconds between SO_RCVBUFAUTO adjustments. */
+#define BSD_RCVBUF_AUTO_PERIOD_MS (250)
+#endif
+
+#ifndef BSD_DNS_CACHE_SIZE
+/** Number of resolved names kept by the resolver cache. */
+#define BSD_DNS_CACHE_SIZE        (8)
+#endif
+
+#ifndef BSD_DNS_CACHE_TTL_MS
+/** Time in milliseconds a resolved name is kept.  SimpleLink does not
+ * report the TTL of the DNS record, so one lifetime applies to all names.
+ */
+#define BSD_DNS_CACHE_TTL_MS      (60000)
+#endif
+
+#ifndef BSD_DNS_ASYNC_STACK_SIZE
+/** Stack size in bytes of the asynchronous resolver thread. */
+#define BSD_DNS_ASYNC_STACK_SIZE  (2048)
+#endif
+
+#ifndef BSD_DNS_ASYNC_PRIORITY
+/** Priority of the asynchronous resolver thread. */
+#define BSD_DNS_ASYNC_PRIORITY    (1)
+#endif
+
+/** Longest host name gethostbyname() accepts. */
+#define BSD_HOST_NAME_MAX         (255)
+
+#ifndef BSD_DNS_NEGATIVE_TTL_MS
+/** Time in milliseconds a failed lookup is remembered, so that repeated
+ * requests for an unreachable name fail at once.
+ */
+#define BSD_DNS_NEGATIVE_TTL_MS   (5000)
+#endif
+
+#ifndef BSD_DNS_INFLIGHT_MAX
+/** Number of distinct names that may be looked up at once with concurrent
+ * requests for the same name sharing one network processor query.
+ */
+#define BSD_DNS_INFLIGHT_MAX      (4)
+#endif
+
+#ifndef BSD_DNS_NAME_MAX
+/** Size of the name buffer of a resolver cache entry, longer names are
+ * resolved but not cached.
+ */
+#define BSD_DNS_NAME_MAX          (64)
+#endif
+
+#ifndef BSD_MDNS_CACHE_SIZE
+/** Number of service instances kept by the DNS-SD service cache. */
+#define BSD_MDNS_CACHE_SIZE       (4)
+#endif
+
+#ifndef BSD_MDNS_CACHE_TTL_MS
+/** Time in milliseconds a resolved service instance is kept.  SimpleLink
+ * does not report the TTL of the records, so the RFC 6762 default of two
+ * minutes for SRV and address records applies to all instances.
+ */
+#define BSD_MDNS_CACHE_TTL_MS     (120000)
+#endif
+
+#ifndef BSD_MDNS_TXT_MAX
+/** Size of the TXT data buffer of a service cache entry. */
+#define BSD_MDNS_TXT_MAX          (64)
+#endif
+
+#ifndef BSD_CONNPOOL_SIZE
+/** Number of connections the connection pool keeps track of, idle or
+ * checked out.
+ */
+#define BSD_CONNPOOL_SIZE         (4)
+#endif
+
+#ifndef BSD_CONNPOOL_MAX_IDLE_MS
+/** Time in milliseconds a pooled connection may stay idle, kept below the
+ * idle timeout of typical HTTP servers.
+ */
+#define BSD_CONNPOOL_MAX_IDLE_MS  (30000)
+#endif
+
+#ifndef BSD_CONNPOOL_MAX_AGE_MS
+/** Time in milliseconds after which a pooled connection is no longer
+ * reused, so that a moved endpoint is picked up again.
+ */
+#define BSD_CONNPOOL_MAX_AGE_MS   (300000)
+#endif
+
+#ifndef BSD_DNS_CACHE_FILE
+/** Name of the file dns_cache_save() and dns_cache_load() use. */
+#define BSD_DNS_CACHE_FILE        "/sys/bsd_dns.bin"
+#endif
+
+/** Header in front of each datagram queued in a socket's rx_buf.
+ */
+struct bsd_dgram_hdr
+{
+    uint16_t length;  /**< payload length in bytes */
+    uint16_t port;    /**< source port, network byte order */
+    uint32_t addr;    /**< source IPv4 address, network byte order */
+};
+
+/** Largest number of bytes handed to sl_Send() in one call. */
+#define BSD_TX_CHUNK        (1460)
+
+/** Reference counted, immutable once queued, transmit buffer.
+ */
+struct txbuf
+{
+    unsigned refs;    /**< number of outstanding references */
+    size_t size;      /**< size of data in bytes */
+    uint8_t data[];   /**< payload */
+};
+
+/** SO_REUSEADDR has been set, or assumed, on the socket */
+#define BSD_OPT_REUSEADDR   (0x01)
+/** SO_BROADCAST has been set on the socket */
+#define BSD_OPT_BROADCAST   (0x02)
+/** TCP_NODELAY has been set, or assumed, on the socket */
+#define BSD_OPT_NODELAY     (0x04)
+/** bsd_socket::rcvbuf holds the network processor's receive window */
+#define BSD_OPT_RCVBUF      (0x08)
+/** SO_RCVBUFAUTO is tuning the network processor's receive window */
+#define BSD_OPT_RCVBUFAUTO  (0x10)
+/** bsd_socket::peer holds the peer, the default one for a SOCK_DGRAM */
+#define BSD_OPT_PEER        (0x20)
+/** bsd_socket::local holds the address the socket is bound to */
+#define BSD_OPT_LOCAL       (0x40)
+/** SO_LINGER is on, bsd_socket::linger holds the timeout */
+#define BSD_OPT_LINGER      (0x80)
+
+/** shutdown() has disallowed further receives */
+#define BSD_SHUT_RD         (0x01)
+/** shutdown() has disallowed further sends */
+#define BSD_SHUT_WR         (0x02)
+/** shutdown(SHUT_RDWR) has closed the network processor socket, the
+ * descriptor stays reserved until close()
+ */
+#define BSD_SHUT_CLOSED     (0x04)
+/** the network processor handed the descriptor of a BSD_SHUT_CLOSED socket
+ * out again, socket() keeps that socket open to hold it until close()
+ */
+#define BSD_SHUT_HELD       (0x08)
+
+/** Host side state kept for each network processor socket descriptor.  The
+ * fields consulted on every call are packed together at the front so that
+ * the common paths touch as little memory as possible, option values only
+ * read by getsockopt() and setsockopt() follow, then pointers.
+ */
+struct bsd_socket
+{
+    uint8_t type;     /**< SOCK_STREAM, SOCK_DGRAM, SOCK_RAW, 0 if unused */
+    uint8_t opts;     /**< BSD_OPT_* flags */
+    uint8_t error;    /**< pending error reported by SO_ERROR, 0 if none */
+    uint8_t tx_async; /**< send() queues data for the send thread */
+    uint8_t rx_demux; /**< rx_buf is filled by the select thread */
+    uint8_t rx_eof;   /**< no more data will be added to rx_buf */
+    uint8_t rx_busy;  /**< the select thread is receiving */
+    uint8_t tx_busy;  /**< a thread is currently draining tx_queue */
+    uint16_t rx_size; /**< size of rx_buf in bytes, 0 if no read-ahead */
+    uint16_t rx_head; /**< index of the oldest buffered byte in rx_buf */
+    uint16_t rx_count;/**< number of bytes buffered in rx_buf */
+    uint16_t tx_offset;/**< bytes of the oldest entry already sent */
+    uint8_t tx_head;  /**< index of the oldest entry in tx_queue */
+    uint8_t tx_count; /**< number of entries in tx_queue */
+    uint8_t nonblock; /**< network processor socket is non-blocking */
+    uint8_t shut;     /**< BSD_SHUT_* flags set by shutdown() */
+    uint32_t rcvbuf;  /**< SO_RCVBUF, valid if BSD_OPT_RCVBUF is set */
+    uint32_t sndbuf;  /**< SO_SNDBUF, as last set by the application */
+    uint32_t rcvtimeo;/**< SO_RCVTIMEO in milliseconds, 0 for none */
+    uint32_t sndtimeo;/**< SO_SNDTIMEO in milliseconds, 0 for none */
+    uint32_t rx_epoch;/**< start of the SO_RCVBUFAUTO sample period */
+    uint32_t rx_bytes;/**< bytes received in the sample period */
+    uint16_t rx_reads;/**< network processor reads in the sample period */
+    uint16_t rx_short;/**< reads in the sample period that drained it */
+    uint16_t linger;  /**< SO_LINGER timeout in seconds */
+    uint16_t keepidle;/**< TCP_KEEPIDLE in seconds, 0 if never set */
+    uint8_t keepalive;/**< SO_KEEPALIVE */
+    uint8_t closing;  /**< close() is releasing the host side state */
+    uint8_t rx_filling;/**< bsd_rx_fill() is receiving into rx_buf */
+    uint8_t rx_readers;/**< threads inside bsd_async_recv() */
+    uint8_t connecting;/**< a non-blocking connect() is in progress */
+    uint8_t reserved[3]; /**< padding */
+    SlSockAddrIn_t peer; /**< peer address, valid if BSD_OPT_PEER is set */
+    SlSockAddrIn_t local;/**< local address, valid if BSD_OPT_LOCAL is set */
+    uint8_t *rx_buf;  /**< read-ahead or receive queue ring buffer */
+    OsiSyncObj_t rx_sem; /**< signaled when the demultiplexer adds data */
+    send_callback_t tx_callback; /**< queued transmission notification */
+    void *tx_context; /**< context passed to tx_callback */
+    struct txbuf *tx_queue[BSD_TXQ_DEPTH]; /**< buffers waiting to be sent */
+};
+
+/** Per-socket state, indexed by socket descriptor. */
+extern struct bsd_socket bsd_sockets[SL_MAX_SOCKETS];
+
+/** Lookup the host side state for a socket descriptor.
+ * @param s socket descriptor
+ * @return socket state, or NULL if the descriptor is out of range
+ */
+static inline struct bsd_socket *bsd_socket_get(int s)
+{
+    if (s < 0 || s >= SL_MAX_SOCKETS)
+    {
+        return NULL;
+    }
+    return &bsd_sockets[s];
+}
+
+/** Number of received bytes buffered on the host for a socket.
+ * @param s socket descriptor
+ * @return number of bytes that can be received without a network processor
+ *         round trip
+ */
+static inline unsigned bsd_socket_rx_pending(int s)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+    return sock ? sock->rx_count : 0;
+}
+
+/** Test if a receive on a socket would complete from host side state alone.
+ * @param s socket descriptor
+ * @return non-zero if data, end of stream, or an error is pending
+ */
+static inline int bsd_socket_rx_ready(int s)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+    return sock && (sock->rx_count || sock->rx_eof ||
+                    (sock->shut & BSD_SHUT_RD));
+}
+
+/** Test if a socket's receive side is handled by the select thread.
+ * @param s socket descriptor
+ * @return non-zero if the network processor must not be polled for it
+ */
+static inline int bsd_socket_rx_demux(int s)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+    return sock && sock->rx_demux;
+}
+
+/** Translate POSIX socket() arguments into their SimpleLink values.
+ * @param domain address family, replaced by the SimpleLink value
+ * @param type socket type, replaced by the SimpleLink value
+ * @param protocol protocol, replaced by the SimpleLink value
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+int bsd_socket_translate(int *domain, int *type, int *protocol);
+
+/** Create a network processor socket from translated arguments.
+ * @param sl_domain SimpleLink address family
+ * @param sl_type SimpleLink socket type
+ * @param sl_protocol SimpleLink protocol
+ * @param type POSIX socket type
+ * @return socket descriptor, otherwise -1 with errno set
+ */
+int bsd_socket_open(int sl_domain, int sl_type, int sl_protocol, int type);
+
+/** Translate a POSIX socket address into a SimpleLink one.
+ * @param address POSIX address
+ * @param sl_address SimpleLink address to fill in
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+int bsd_sockaddr_translate(const struct sockaddr *address,
+                           SlSockAddr_t *sl_address);
+
+/** Bind a socket to an already translated address.
+ * @param s socket descriptor
+ * @param sl_address SimpleLink address
+ * @param address_len length of the address
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+int bsd_bind(int s, const SlSockAddr_t *sl_address, socklen_t address_len);
+
+/** Test if a socket is a SOCK_DGRAM socket with a default peer.
+ * @param sock host side socket state, may be NULL
+ * @return non-zero if sends go to, and receives only come from, sock->peer
+ */
+static inline int bsd_socket_dgram_peer(struct bsd_socket *sock)
+{
+    return sock && sock->type == SOCK_DGRAM && (sock->opts & BSD_OPT_PEER);
+}
+
+/** Test if a datagram source matches the default peer of a socket.
+ * @param sock host side socket state
+ * @param from source address of the datagram
+ * @return non-zero if the datagram should be delivered
+ */
+static inline int bsd_socket_peer_match(struct bsd_socket *sock,
+                                        const SlSockAddrIn_t *from)
+{
+    return from->sin_port == sock->peer.sin_port &&
+           from->sin_addr.s_addr == sock->peer.sin_addr.s_addr;
+}
+
+/** Send on the network processor socket, to the default peer for a
+ * connected SOCK_DGRAM socket.
+ * @param s socket descriptor
+ * @param sock host side socket state, may be NULL
+ * @param buffer data to send
+ * @param length length of the data in bytes
+ * @param flags SimpleLink flags
+ * @return the SimpleLink result
+ */
+static inline int bsd_sl_send(int s, struct bsd_socket *sock,
+                              const void *buffer, size_t length, int flags)
+{
+    if (bsd_socket_dgram_peer(sock))
+    {
+        /* the address was translated once by connect() */
+        return sl_SendTo(s, buffer, length, flags, (SlSockAddr_t*)&sock->peer,
+                         sizeof(sock->peer));
+    }
+    return sl_Send(s, buffer, length, flags);
+}
+
+#ifndef BSD_KEEPIDLE_DEFAULT
+/** Keepalive idle time in seconds used by the network processor until
+ * TCP_KEEPIDLE is set.
+ */
+#define BSD_KEEPIDLE_DEFAULT (300)
+#endif
+
+/** Translate the SimpleLink errors that report a lost connection, as
+ * detected by keepalive probes or a reset from the peer, into errno.
+ * @param result negative result from a SimpleLink call
+ * @return non-zero if errno has been set
+ */
+static inline int bsd_conn_error(int result)
+{
+    switch (result)
+    {
+        default:
+            return 0;
+#if defined(SL_ECONNRESET)
+        case SL_ECONNRESET:
+            errno = ECONNRESET;
+            return 1;
+#endif
+#if defined(SL_ETIMEDOUT)
+        case SL_ETIMEDOUT:
+            errno = ETIMEDOUT;
+            return 1;
+#endif
+    }
+}
+
+/** Build a getaddrinfo() result chain as a single allocation, one entry per
+ * socket type unless the hints name one.
+ * @param canonname name to return as ai_canonname if AI_CANONNAME is set,
+ *                  may be NULL
+ * @param addr IPv4 address, network byte order
+ * @param port port, network byte order
+ * @param hints hints given to getaddrinfo(), may be NULL
+ * @param res resulting chain, freed by freeaddrinfo()
+ * @return 0 upon success, otherwise an EAI_* error code
+ */
+int bsd_addrinfo_build(const char *canonname, uint32_t addr, uint16_t port,
+                       const struct addrinfo *hints, struct addrinfo **res);
+
+/** Parse an IPv4 address in strict dotted decimal notation, d.d.d.d, without
+ * leading zeros.
+ * @param src text to parse
+ * @param addr parsed address, network byte order
+ * @return 1 on success, 0 if src is not a dotted decimal IPv4 address
+ */
+int bsd_inet_parse4(const char *src, uint32_t *addr);
+
+/** Resolve a host name, answering from the resolver cache when possible.
+ * @param name host name
+ * @param family SimpleLink address family
+ * @param addr resolved address, in the byte order SimpleLink returns it
+ * @return 0 upon success, otherwise the SimpleLink error code
+ */
+int bsd_dns_lookup(const char *name, uint8_t family, unsigned long *addr);
+
+/** Look a host name up with the network processor and update the resolver
+ * cache, regardless of what it holds.
+ * @param name host name
+ * @param family SimpleLink address family
+ */
+void bsd_dns_refresh(const char *name, uint8_t family);
+
+/** Look a service instance up with the network processor and update the
+ * service cache, regardless of what it holds.
+ * @param name service instance name
+ * @param family SimpleLink address family
+ */
+void bsd_mdns_refresh(const char *name, uint8_t family);
+
+/** Discard all service instances cached by getaddrinfo_service().
+ */
+void bsd_mdns_flush(void);
+
+/** Cache refresh performed by the asynchronous resolver thread.
+ * @param name name to look up
+ * @param family SimpleLink address family
+ */
+typedef void (*bsd_refresh_t)(const char *name, uint8_t family);
+
+/** Queue a cache refresh to the asynchronous resolver thread.
+ * @param refresh bsd_dns_refresh() or bsd_mdns_refresh()
+ * @param name name to look up, copied
+ * @param family SimpleLink address family
+ * @return 0 upon success, otherwise -1
+ */
+int bsd_refresh_async(bsd_refresh_t refresh, const char *name,
+                      uint8_t family);
+
+/** Close the least recently used idle connection of the connection pool,
+ * giving its socket back to the network processor.
+ * @return non-zero if a connection was closed
+ */
+int bsd_connpool_evict(void);
+
+/** Forget a socket being closed, should it belong to the connection pool.
+ * @param s the socket file descriptor
+ */
+void bsd_connpool_closed(int s);
+
+/** Translate a failed sl_Recv() or sl_RecvFrom() result into errno.
+ * @param result negative result from the SimpleLink receive call
+ * @return -1
+ */
+int bsd_recv_error(int result);
+
+/** Receive as much as fits into the contiguous free space of a socket's
+ * rx_buf with a single network processor read.  Only one thread may fill a
+ * given socket's rx_buf.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @return number of bytes added, 0 on orderly shutdown by the peer, or -1
+ *         with errno set on error
+ */
+int bsd_rx_fill(int s, struct bsd_socket *sock);
+
+/** Copy stream data out of a socket's rx_buf.
+ * @param sock host side socket state
+ * @param buffer destination buffer
+ * @param length size of the destination buffer in bytes
+ * @param peek true if the data should be left in rx_buf
+ * @return number of bytes copied
+ */
+int bsd_rx_copy(struct bsd_socket *sock, uint8_t *buffer, size_t length,
+                int peek);
+
+/** Turn receive window auto-tuning on or off for a socket.  When turned on
+ * the window starts at BSD_RCVBUF_AUTO_MIN.
+ * @param s socket descriptor
+ * @param enable non-zero to turn auto-tuning on
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+int bsd_rcvbuf_auto(int s, int enable);
+
+/** Account for a network processor read and adjust the receive window once
+ * per sample period.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @param result bytes returned by the read
+ * @param requested bytes the read asked for
+ */
+void bsd_rcvbuf_tune(int s, struct bsd_socket *sock, int result,
+                     size_t requested);
+
+/** Shrink the receive window of SO_RCVBUFAUTO sockets that went quiet,
+ * which the receive path alone never notices.  Called by the select thread
+ * on each pass.
+ * @return milliseconds until a window may have to be shrunk again,
+ *         OSI_WAIT_FOREVER if all windows are at BSD_RCVBUF_AUTO_MIN
+ */
+uint32_t bsd_rcvbuf_idle(void);
+
+/** Feed a successful network processor read to SO_RCVBUFAUTO, if set.
+ * @param s socket descriptor
+ * @param sock host side socket state, may be NULL
+ * @param result bytes returned by the read
+ * @param requested bytes the read asked for
+ */
+static inline void bsd_rcvbuf_account(int s, struct bsd_socket *sock,
+                                      int result, size_t requested)
+{
+    if (sock && (sock->opts & BSD_OPT_RCVBUFAUTO) && result > 0)
+    {
+        bsd_rcvbuf_tune(s, sock, result, requested);
+    }
+}
+
+/** Hand a socket's receive side over to the select thread, starting
+ * the thread if needed.
+ * @param s socket descriptor
+ * @param size size of the socket's receive queue in bytes
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+int bsd_async_recv_start(int s, int size);
+
+/** Count the bytes the next receive on a demultiplexed socket returns
+ * without blocking.
+ * @param sock host side socket state
+ * @return bytes queued for a stream socket, size of the next datagram for a
+ *         datagram socket
+ */
+int bsd_async_recv_pending(struct bsd_socket *sock);
+
+/** Collect the SO_RXDEMUX sockets with room in their receive queues.
+ * @param readfds set to fill in
+ * @return highest socket in readfds plus 1, 0 if there is none
+ */
+int bsd_async_recv_fds(SlFdSet_t *readfds);
+
+/** Receive into the queues of the SO_RXDEMUX sockets sl_Select() reported
+ * readable.  Only called by the select thread.
+ * @param nfds highest numbered file descriptor in the sets plus 1
+ * @param demux sockets collected by bsd_async_recv_fds()
+ * @param readfds read set returned by sl_Select()
+ */
+void bsd_async_recv_service(int nfds, SlFdSet_t *demux, SlFdSet_t *readfds);
+
+/** Receive from the queue filled by the select thread.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @param buffer buffer where the message should be stored
+ * @param length length in bytes of the buffer
+ * @param flags MSG_PEEK and/or MSG_DONTWAIT, or 0
+ * @param src_addr if not NULL, source address of a datagram
+ * @param addrlen size of src_addr
+ * @return see recvfrom()
+ */
+int bsd_async_recv(int s, struct bsd_socket *sock, void *buffer,
+                   size_t length, int flags, struct sockaddr *src_addr,
+                   socklen_t *addrlen);
+
+/** Translate a failed sl_Send() or sl_SendTo() result into errno.
+ * @param result negative result from the SimpleLink send call
+ * @return -1
+ */
+int bsd_send_error(int result);
+
+/** Transmit as much of the socket's transmit queue as the network processor
+ * will take.  Returns immediately if another thread is already draining it.
+ * @param s socket descriptor
+ * @return number of bytes still queued, or -1 with errno set on error, in
+ *         which case the queue has been discarded
+ */
+int bsd_txq_flush(int s);
+
+/** Hand at most one chunk of the socket's transmit queue to the network
+ * processor, used once sl_Select() reported the socket writable so that
+ * the send does not block.
+ * @param s socket descriptor
+ * @return see bsd_txq_flush()
+ */
+int bsd_txq_flush_once(int s);
+
+/** Append a reference to a transmit buffer to a socket's transmit queue.
+ * @param s socket descriptor
+ * @param buf buffer to queue
+ * @return 0 upon success, otherwise -1 with errno set, ENOBUFS if the queue
+ *         is full
+ */
+int bsd_txq_push(int s, struct txbuf *buf);
+
+/** Drop every buffer queued on a socket, used when the socket is closed.
+ * @param sock host side socket state
+ */
+void bsd_txq_purge(struct bsd_socket *sock);
+
+/** Start the asynchronous send thread if it is not already running.
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+int bsd_async_send_start(void);
+
+/** Wake the asynchronous send thread after queueing data for it.
+ */
+void bsd_async_send_wake(void);
+
+/** Queue a copy of a message for the asynchronous send thread.
+ * @param s socket descriptor
+ * @param buffer message to send
+ * @param length length of the message in bytes
+ * @param flags MSG_DONTWAIT or 0
+ * @return length upon success, otherwise -1 with errno set, EAGAIN if the
+ *         queue is full and the call must not block
+ */
+int bsd_async_send(int s, const void *buffer, size_t length, int flags);
+
+/** Start the select thread if it is not already running.
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+int bsd_select_start(void);
+
+/** Make the select thread recompute what it waits for, after a thread
+ * started waiting, a receive queue got room or host side state changed.
+ */
+void bsd_select_kick(void);
+
+/** The only way the wrapper waits on the network processor.  The SimpleLink
+ * host driver does not support concurrent sl_Select() calls, so the select
+ * thread makes the only one, on the union of the sets of all waiting
+ * threads, and each caller blocks on a semaphore until its sets are ready
+ * or its timeout expires.
+ * @param nfds highest numbered file descriptor in any of the three sets
+ *             plus 1
+ * @param readfds set to pend on read active, may be NULL
+ * @param writefds set to pend on write active, may be NULL
+ * @param exceptfds set to pend on error active, may be NULL
+ * @param timeout time to wait, NULL to wait forever
+ * @return result of sl_Select() restricted to the given sets
+ */
+int16_t bsd_select(int nfds, SlFdSet_t *readfds, SlFdSet_t *writefds,
+                   SlFdSet_t *exceptfds, SlTimeval_t *timeout);
+
+/** bsd_select() that can be cut short by another thread.
+ * @param nfds highest numbered file descriptor in any of the three sets
+ *             plus 1
+ * @param readfds set to pend on read active, may be NULL
+ * @param writefds set to pend on write active, may be NULL
+ * @param exceptfds set to pend on error active, may be NULL
+ * @param timeout time to wait, NULL to wait forever
+ * @param intr returns 0, as if timed out, once another thread sets this
+ *             and calls bsd_select_kick()
+ * @return result of sl_Select() restricted to the given sets
+ */
+int16_t bsd_select_intr(int nfds, SlFdSet_t *readfds, SlFdSet_t *writefds,
+                        SlFdSet_t *exceptfds, SlTimeval_t *timeout,
+                        volatile uint8_t *intr);
+
+/** Wait for a socket to become readable or writable at the network
+ * processor.
+ * @param s socket descriptor
+ * @param write true to wait for writable, false for readable
+ * @param timeout time to wait, NULL to wait forever
+ * @return 1 if ready, 0 on timeout, otherwise -1 with errno set
+ */
+int bsd_wait_ready(int s, int write, SlTimeval_t *timeout);
+
+/** Millisecond clock used for host enforced deadlines.  The default uses
+ * gettimeofday() (clock() with the TI compiler), it is weak so that an
+ * application can provide a monotonic tick based implementation.
+ * @return milliseconds since an arbitrary epoch, wrapping at 2^32
+ */
+uint32_t bsd_clock_ms(void);
+
+/** Convert milliseconds to a SimpleLink timeval.
+ * @param tv timeval to fill in
+ * @param ms time in milliseconds
+ */
+static inline void bsd_ms_to_timeval(SlTimeval_t *tv, uint32_t ms)
+{
+    tv->tv_sec = ms / 1000;
+    tv->tv_usec = (ms % 1000) * 1000;
+}
+
+/** Switch the network processor socket between blocking and non-blocking
+ * mode, skipping the round trip if the mode does not change.
+ * @param s socket descriptor
+ * @param nonblock non-zero for non-blocking
+ * @return 0 upon success, otherwise -1 with errno set
+ */
+int bsd_set_nonblocking(int s, int nonblock);
+
+/** Enter a short critical section protecting the host side socket state.
+ * Never call into the SimpleLink driver while holding it.
+ * @return key to pass to @ref bsd_unlock()
+ */
+static inline unsigned long bsd_lock(void)
+{
+    return osi_EnterCritical();
+}
+
+/** Leave a critical section entered with @ref bsd_lock().
+ * @param key value returned by the matching @ref bsd_lock()
+ */
+static inline void bsd_unlock(unsigned long key)
+{
+    osi_ExitCritical(key);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BSD_SOCKET_PRIV_H_ */
@@ -0,0 +1,399 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_txbuf.c
+ * This file implements reference counted transmit buffers that can be
+ * queued on many sockets without being copied.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <errno.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/*
+ * ::txbuf_alloc()
+ */
+struct txbuf *txbuf_alloc(size_t size)
+{
+    struct txbuf *buf = malloc(sizeof(struct txbuf) + size);
+
+    if (buf == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    buf->refs = 1;
+    buf->size = size;
+    return buf;
+}
+
+/*
+ * ::txbuf_data()
+ */
+void *txbuf_data(struct txbuf *buf)
+{
+    return buf->data;
+}
+
+/*
+ * ::txbuf_size()
+ */
+size_t txbuf_size(struct txbuf *buf)
+{
+    return buf->size;
+}
+
+/*
+ * ::txbuf_ref()
+ */
+struct txbuf *txbuf_ref(struct txbuf *buf)
+{
+    unsigned long key = bsd_lock();
+    ++buf->refs;
+    bsd_unlock(key);
+
+    return buf;
+}
+
+/*
+ * ::txbuf_unref()
+ */
+void txbuf_unref(struct txbuf *buf)
+{
+    if (buf == NULL)
+    {
+        return;
+    }
+
+    unsigned long key = bsd_lock();
+    unsigned refs = --buf->refs;
+    bsd_unlock(key);
+
+    if (refs == 0)
+    {
+        free(buf);
+    }
+}
+
+/*
+ * bsd_txq_purge()
+ */
+void bsd_txq_purge(struct bsd_socket *sock)
+{
+    unsigned long key = bsd_lock();
+    while (sock->tx_count)
+    {
+        struct txbuf *buf = sock->tx_queue[sock->tx_head];
+        sock->tx_queue[sock->tx_head] = NULL;
+        sock->tx_head = (sock->tx_head + 1) % BSD_TXQ_DEPTH;
+        --sock->tx_count;
+        bsd_unlock(key);
+        txbuf_unref(buf);
+        key = bsd_lock();
+    }
+    sock->tx_offset = 0;
+    bsd_unlock(key);
+}
+
+/** Count the bytes waiting in a socket's transmit queue, must be called with
+ * the critical section held.
+ * @param sock host side socket state
+ * @return number of bytes not yet sent
+ */
+static int txq_pending(struct bsd_socket *sock)
+{
+    int pending = 0;
+
+    for (unsigned i = 0; i < sock->tx_count; ++i)
+    {
+        pending += sock->tx_queue[(sock->tx_head + i) % BSD_TXQ_DEPTH]->size;
+    }
+
+    return pending - sock->tx_offset;
+}
+
+/** Report the completion or failure of a queued transmission to the socket's
+ * callback, if any.
+ * @param s socket descriptor
+ * @param sock host side socket state
+ * @param error 0 if a buffer was sent completely, else the errno value
+ */
+static void txq_notify(int s, struct bsd_socket *sock, int error)
+{
+    unsigned long key = bsd_lock();
+    send_callback_t callback = sock->tx_callback;
+    void *context = sock->tx_context;
+    bsd_unlock(key);
+
+    if (callback)
+    {
+        callback(s, error, context);
+    }
+}
+
+/** Transmit from the socket's transmit queue.  Returns immediately if
+ * another thread is already draining it.
+ * @param s socket descriptor
+ * @param once true to hand at most one chunk to the network processor
+ * @return number of bytes still queued, or -1 with errno set on error, in
+ *         which case the queue has been discarded
+ */
+static int txq_flush(int s, int once)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL)
+    {
+        return 0;
+    }
+
+    unsigned long key = bsd_lock();
+    if (sock->tx_busy || sock->tx_count == 0)
+    {
+        int pending = txq_pending(sock);
+        bsd_unlock(key);
+        return pending;
+    }
+    sock->tx_busy = 1;
+
+    while (sock->tx_count)
+    {
+        struct txbuf *buf = sock->tx_queue[sock->tx_head];
+        size_t offset = sock->tx_offset;
+        /* hold our own reference while the driver reads the payload, the
+         * queue may be purged by close() in the meantime
+         */
+        ++buf->refs;
+        bsd_unlock(key);
+
+        size_t length = buf->size - offset;
+        if (length > BSD_TX_CHUNK && sock->type == SOCK_STREAM)
+        {
+            /* never split a datagram */
+            length = BSD_TX_CHUNK;
+        }
+
+        int result = length ?
+            bsd_sl_send(s, sock, buf->data + offset, length, 0) : 0;
+
+        if (result < 0)
+        {
+            bsd_send_error(result);
+            txbuf_unref(buf);
+            if (errno == EAGAIN)
+            {
+                /* non-blocking socket, try again later */
+                key = bsd_lock();
+                break;
+            }
+            int error = errno;
+            bsd_txq_purge(sock);
+            key = bsd_lock();
+            sock->tx_busy = 0;
+            bsd_unlock(key);
+            txq_notify(s, sock, error);
+            errno = error;
+            return -1;
+        }
+
+        int done = 0;
+        key = bsd_lock();
+        if (sock->tx_count && sock->tx_queue[sock->tx_head] == buf)
+        {
+            sock->tx_offset += result;
+            if (sock->tx_offset >= buf->size)
+            {
+                sock->tx_queue[sock->tx_head] = NULL;
+                sock->tx_head = (sock->tx_head + 1) % BSD_TXQ_DEPTH;
+                --sock->tx_count;
+                sock->tx_offset = 0;
+                done = 1;
+            }
+        }
+        bsd_unlock(key);
+
+        if (done)
+        {
+            /* the reference held by the queue */
+            txbuf_unref(buf);
+            txq_notify(s, sock, 0);
+        }
+        txbuf_unref(buf);
+        key = bsd_lock();
+        if (once)
+        {
+            break;
+        }
+    }
+
+    int pending = txq_pending(sock);
+    sock->tx_busy = 0;
+    bsd_unlock(key);
+
+    return pending;
+}
+
+/*
+ * bsd_txq_flush()
+ */
+int bsd_txq_flush(int s)
+{
+    return txq_flush(s, 0);
+}
+
+/*
+ * bsd_txq_flush_once()
+ */
+int bsd_txq_flush_once(int s)
+{
+    return txq_flush(s, 1);
+}
+
+/*
+ * bsd_txq_push()
+ */
+int bsd_txq_push(int s, struct txbuf *buf)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (sock->shut & BSD_SHUT_WR)
+    {
+        errno = EPIPE;
+        return -1;
+    }
+
+    txbuf_ref(buf);
+
+    unsigned long key = bsd_lock();
+    if (sock->tx_count >= BSD_TXQ_DEPTH)
+    {
+        bsd_unlock(key);
+        txbuf_unref(buf);
+        errno = ENOBUFS;
+        return -1;
+    }
+    sock->tx_queue[(sock->tx_head + sock->tx_count) % BSD_TXQ_DEPTH] = buf;
+    ++sock->tx_count;
+    bsd_unlock(key);
+
+    return 0;
+}
+
+/*
+ * ::send_buf()
+ */
+int send_buf(int s, struct txbuf *buf)
+{
+    if (bsd_txq_push(s, buf) < 0)
+    {
+        return -1;
+    }
+
+    if (bsd_sockets[s].tx_async)
+    {
+        bsd_async_send_wake();
+        return 0;
+    }
+
+    return bsd_txq_flush(s) < 0 ? -1 : 0;
+}
+
+/*
+ * ::send_fanout()
+ */
+int send_fanout(const int *sockets, int count, struct txbuf *buf)
+{
+    int queued = 0;
+
+    /* queue everywhere first so that slow sockets do not delay the rest */
+    int async = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (bsd_txq_push(sockets[i], buf) == 0)
+        {
+            ++queued;
+            async |= bsd_sockets[sockets[i]].tx_async;
+        }
+    }
+
+    if (async)
+    {
+        bsd_async_send_wake();
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        struct bsd_socket *sock = bsd_socket_get(sockets[i]);
+        if (sock && !sock->tx_async && bsd_txq_flush(sockets[i]) < 0)
+        {
+            /* reported by the next operation on the socket */
+            sock->error = errno;
+        }
+    }
+
+    return queued;
+}
+
+/*
+ * ::send_set_callback()
+ */
+int send_set_callback(int s, send_callback_t callback, void *context)
+{
+    struct bsd_socket *sock = bsd_socket_get(s);
+
+    if (sock == NULL || sock->type == 0)
+    {
+        errno = EBADF;
+        return -1;
+    }
+
+    unsigned long key = bsd_lock();
+    sock->tx_callback = callback;
+    sock->tx_context = context;
+    bsd_unlock(key);
+
+    return 0;
+}
+
+/*
+ * ::send_flush()
+ */
+int send_flush(int s)
+{
+    return bsd_txq_flush(s);
+}
@@ -0,0 +1,142 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file bsd_zerocopy.c
+ * This file implements receive into buffers loaned from a fixed pool.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <errno.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+#if BSD_ZC_BLOCK_COUNT > 32
+#error "BSD_ZC_BLOCK_COUNT must not exceed 32"
+#endif
+
+/** start of the buffer pool, allocated once on first use */
+static uint8_t *zc_pool = NULL;
+
+/** bit mask of the pool blocks currently on loan */
+static uint32_t zc_in_use = 0;
+
+/** Take a free block from the pool.
+ * @return block, otherwise NULL with errno set, ENOMEM if the pool could not
+ *         be allocated, ENOBUFS if all blocks are on loan
+ */
+static uint8_t *zc_alloc(void)
+{
+    if (zc_pool == NULL)
+    {
+        uint8_t *pool = malloc(BSD_ZC_BLOCK_COUNT * BSD_ZC_BLOCK_SIZE);
+        if (pool == NULL)
+        {
+            errno = ENOMEM;
+            return NULL;
+        }
+        unsigned long key = bsd_lock();
+        if (zc_pool == NULL)
+        {
+            zc_pool = pool;
+            pool = NULL;
+        }
+        bsd_unlock(key);
+        /* another thread may have won the race */
+        free(pool);
+    }
+
+    uint8_t *block = NULL;
+    unsigned long key = bsd_lock();
+    for (int i = 0; i < BSD_ZC_BLOCK_COUNT; ++i)
+    {
+        if (!(zc_in_use & (1UL << i)))
+        {
+            zc_in_use |= 1UL << i;
+            block = zc_pool + (i * BSD_ZC_BLOCK_SIZE);
+            break;
+        }
+    }
+    bsd_unlock(key);
+
+    if (block == NULL)
+    {
+        errno = ENOBUFS;
+    }
+    return block;
+}
+
+/*
+ * ::recv_release()
+ */
+void recv_release(void *buffer)
+{
+    if (buffer == NULL || zc_pool == NULL)
+    {
+        return;
+    }
+
+    unsigned index = ((uint8_t*)buffer - zc_pool) / BSD_ZC_BLOCK_SIZE;
+    if (index < BSD_ZC_BLOCK_COUNT)
+    {
+        unsigned long key = bsd_lock();
+        zc_in_use &= ~(1UL << index);
+        bsd_unlock(key);
+    }
+}
+
+/*
+ * ::recv_zc()
+ */
+int recv_zc(int s, void **buffer, size_t length, int flags)
+{
+    uint8_t *block = zc_alloc();
+
+    *buffer = NULL;
+    if (block == NULL)
+    {
+        return -1;
+    }
+
+    if (length > BSD_ZC_BLOCK_SIZE)
+    {
+        length = BSD_ZC_BLOCK_SIZE;
+    }
+
+    int result = recv(s, block, length, flags);
+
+    if (result <= 0)
+    {
+        recv_release(block);
+        return result;
+    }
+
+    *buffer = block;
+    return result;
+}
@@ -0,0 +1,927 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file simplelink.c
+ * This file simulates the parts of the OSI layer and of the SimpleLink
+ * network processor the wrapper uses, so that the wrapper can be tested on
+ * the host.  The OSI layer maps onto pthreads.  Sockets live in memory: data
+ * arrives through stub_inject(), sends are counted, and sl_Select() reports
+ * the state the tests set up.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "socket.h"
+
+/** bytes a simulated socket can hold before the test has to drain it */
+#define STUB_RX_SIZE (8192)
+
+/** datagrams a simulated socket can hold */
+#define STUB_DGRAMS (16)
+
+/** receive window a new socket reports */
+#define STUB_RCVBUF (8192)
+
+/** address every DNS lookup resolves to, host byte order */
+#define STUB_DNS_ADDR (0x0A000001UL)
+
+/** One simulated network processor socket. */
+struct stub_socket
+{
+    int open;              /**< socket is open */
+    int type;              /**< SimpleLink socket type */
+    int nonblock;          /**< SL_SO_NONBLOCKING */
+    int writable;          /**< sends go through */
+    int eof;               /**< peer closed the connection */
+    int sent;              /**< bytes transmitted */
+    _u32 rcvbuf;           /**< SL_SO_RCVBUF */
+    _u16 port;             /**< bound port, network byte order */
+    int rx_count;          /**< bytes in rx */
+    int dgram_count;       /**< datagrams in rx */
+    int dgram_len[STUB_DGRAMS]; /**< length of each datagram in rx */
+    SlSockAddrIn_t dgram_from[STUB_DGRAMS]; /**< source of each datagram */
+    _u8 rx[STUB_RX_SIZE];  /**< received data not read yet */
+};
+
+/** the simulated sockets */
+static struct stub_socket sockets[SL_MAX_SOCKETS];
+
+/** protects sockets and the DNS state */
+static pthread_mutex_t nwp_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** broadcast on every change of sockets or of the DNS state */
+static pthread_cond_t nwp_cond = PTHREAD_COND_INITIALIZER;
+
+/** DNS lookups are held until released */
+static int dns_hold;
+
+/** DNS lookups started */
+static int dns_calls;
+
+/** connections made */
+static int connects;
+
+/** the osi_EnterCritical() lock, recursive like the real one */
+static pthread_mutex_t critical;
+
+/** initializes critical once */
+static pthread_once_t critical_once = PTHREAD_ONCE_INIT;
+
+/** A binary semaphore. */
+struct stub_sync
+{
+    pthread_mutex_t mutex; /**< protects signaled */
+    pthread_cond_t cond;   /**< broadcast when signaled is set */
+    int signaled;          /**< semaphore is signaled */
+};
+
+/** Arguments of a new thread. */
+struct stub_task
+{
+    P_OSI_TASK_ENTRY entry; /**< thread entry point, or NULL */
+    P_OSI_SPAWN_ENTRY spawn; /**< spawned function if entry is NULL */
+    void *arg;             /**< argument of entry or spawn */
+};
+
+/** Convert a relative timeout to an absolute CLOCK_REALTIME time.
+ * @param ts absolute time
+ * @param ms timeout in milliseconds
+ */
+static void stub_deadline(struct timespec *ts, unsigned long ms)
+{
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (ms % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L)
+    {
+        ts->tv_sec += 1;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/** Create the recursive critical section lock. */
+static void critical_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/*
+ * osi_EnterCritical()
+ */
+unsigned long osi_EnterCritical(void)
+{
+    pthread_once(&critical_once, critical_init);
+    pthread_mutex_lock(&critical);
+    return 0;
+}
+
+/*
+ * osi_ExitCritical()
+ */
+void osi_ExitCritical(unsigned long key)
+{
+    (void)key;
+    pthread_mutex_unlock(&critical);
+}
+
+/*
+ * osi_SyncObjCreate()
+ */
+OsiReturnVal_e osi_SyncObjCreate(OsiSyncObj_t *sync)
+{
+    struct stub_sync *s = malloc(sizeof(*s));
+    if (s == NULL)
+    {
+        return OSI_OPERATION_FAILED;
+    }
+    pthread_mutex_init(&s->mutex, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    s->signaled = 0;
+    *sync = s;
+    return OSI_OK;
+}
+
+/*
+ * osi_SyncObjDelete()
+ */
+OsiReturnVal_e osi_SyncObjDelete(OsiSyncObj_t *sync)
+{
+    struct stub_sync *s = *sync;
+    pthread_mutex_destroy(&s->mutex);
+    pthread_cond_destroy(&s->cond);
+    /* make a use after delete fail loudly */
+    memset(s, 0xA5, sizeof(*s));
+    free(s);
+    *sync = NULL;
+    return OSI_OK;
+}
+
+/*
+ * osi_SyncObjWait()
+ */
+OsiReturnVal_e osi_SyncObjWait(OsiSyncObj_t *sync, OsiTime_t timeout)
+{
+    struct stub_sync *s = *sync;
+    struct timespec ts;
+    int timed_out = 0;
+
+    stub_deadline(&ts, timeout);
+    pthread_mutex_lock(&s->mutex);
+    while (!s->signaled && !timed_out)
+    {
+        if (timeout == OSI_WAIT_FOREVER)
+        {
+            pthread_cond_wait(&s->cond, &s->mutex);
+        }
+        else
+        {
+            timed_out = pthread_cond_timedwait(&s->cond, &s->mutex, &ts) != 0;
+        }
+    }
+    int signaled = s->signaled;
+    s->signaled = 0;
+    pthread_mutex_unlock(&s->mutex);
+
+    return signaled ? OSI_OK : OSI_OPERATION_FAILED;
+}
+
+/*
+ * osi_SyncObjSignal()
+ */
+OsiReturnVal_e osi_SyncObjSignal(OsiSyncObj_t *sync)
+{
+    struct stub_sync *s = *sync;
+    pthread_mutex_lock(&s->mutex);
+    s->signaled = 1;
+    pthread_cond_broadcast(&s->cond);
+    pthread_mutex_unlock(&s->mutex);
+    return OSI_OK;
+}
+
+/*
+ * osi_SyncObjClear()
+ */
+OsiReturnVal_e osi_SyncObjClear(OsiSyncObj_t *sync)
+{
+    struct stub_sync *s = *sync;
+    pthread_mutex_lock(&s->mutex);
+    s->signaled = 0;
+    pthread_mutex_unlock(&s->mutex);
+    return OSI_OK;
+}
+
+/** Entry point of the pthreads made by osi_TaskCreate().
+ * @param arg struct stub_task allocated by the creator
+ * @return NULL
+ */
+static void *stub_task_entry(void *arg)
+{
+    struct stub_task task = *(struct stub_task*)arg;
+    free(arg);
+    if (task.entry)
+    {
+        task.entry(task.arg);
+    }
+    else
+    {
+        task.spawn(task.arg);
+    }
+    return NULL;
+}
+
+/** Start a thread.
+ * @param entry thread entry point, or NULL
+ * @param spawn spawned function if entry is NULL
+ * @param arg argument of entry or spawn
+ * @return OSI_OK upon success, else OSI_OPERATION_FAILED
+ */
+static OsiReturnVal_e stub_task_create(P_OSI_TASK_ENTRY entry,
+                                       P_OSI_SPAWN_ENTRY spawn, void *arg)
+{
+    pthread_t thread;
+    struct stub_task *task = malloc(sizeof(*task));
+    if (task == NULL)
+    {
+        return OSI_OPERATION_FAILED;
+    }
+    task->entry = entry;
+    task->spawn = spawn;
+    task->arg = arg;
+
+    if (pthread_create(&thread, NULL, stub_task_entry, task) != 0)
+    {
+        free(task);
+        return OSI_OPERATION_FAILED;
+    }
+    pthread_detach(thread);
+    return OSI_OK;
+}
+
+/*
+ * osi_TaskCreate()
+ */
+OsiReturnVal_e osi_TaskCreate(P_OSI_TASK_ENTRY entry,
+                              const signed char * const name,
+                              unsigned short stack_size, void *arg,
+                              unsigned long priority, OsiTaskHandle *handle)
+{
+    return stub_task_create(entry, NULL, arg);
+}
+
+/*
+ * osi_Spawn()
+ */
+OsiReturnVal_e osi_Spawn(P_OSI_SPAWN_ENTRY entry, void *arg,
+                         unsigned long flags)
+{
+    /* the driver's spawn task runs it later, a new thread is close enough */
+    return stub_task_create(NULL, entry, arg);
+}
+
+/*
+ * osi_Sleep()
+ */
+void osi_Sleep(unsigned int ms)
+{
+    usleep(ms * 1000);
+}
+
+/*
+ * sl_Htonl()
+ */
+_u32 sl_Htonl(_u32 val)
+{
+    return __builtin_bswap32(val);
+}
+
+/*
+ * sl_Htons()
+ */
+_u16 sl_Htons(_u16 val)
+{
+    return __builtin_bswap16(val);
+}
+
+/*
+ * sl_Ntohl()
+ */
+_u32 sl_Ntohl(_u32 val)
+{
+    return __builtin_bswap32(val);
+}
+
+/*
+ * sl_Ntohs()
+ */
+_u16 sl_Ntohs(_u16 val)
+{
+    return __builtin_bswap16(val);
+}
+
+/** newlib reentrant close, implemented by the wrapper */
+int _close_r(struct _reent *reent, int s);
+
+/*
+ * close()
+ */
+int close(int fd)
+{
+    /* as newlib does on the target, route close() to the wrapper */
+    return _close_r(NULL, fd);
+}
+
+/** Test if a socket descriptor refers to an open socket.  Must be called
+ * with nwp_mutex held.
+ * @param sd SimpleLink socket descriptor
+ * @return socket, or NULL if sd is not open
+ */
+static struct stub_socket *stub_socket_get(int sd)
+{
+    if (sd < 0 || sd >= SL_MAX_SOCKETS || !sockets[sd].open)
+    {
+        return NULL;
+    }
+    return &sockets[sd];
+}
+
+/** Append received data to a socket.  Must be called with nwp_mutex held.
+ * @param sock socket
+ * @param data payload
+ * @param len length of data in bytes
+ * @param from source address of a datagram, may be NULL
+ */
+static void stub_deliver(struct stub_socket *sock, const void *data, int len,
+                         const SlSockAddrIn_t *from)
+{
+    if (sock->rx_count + len > STUB_RX_SIZE ||
+        (sock->type != SL_SOCK_STREAM && sock->dgram_count == STUB_DGRAMS))
+    {
+        /* dropped, as the network processor would */
+        return;
+    }
+
+    if (sock->type != SL_SOCK_STREAM)
+    {
+        sock->dgram_len[sock->dgram_count] = len;
+        memset(&sock->dgram_from[sock->dgram_count], 0,
+               sizeof(SlSockAddrIn_t));
+        if (from)
+        {
+            sock->dgram_from[sock->dgram_count] = *from;
+        }
+        ++sock->dgram_count;
+    }
+    memcpy(sock->rx + sock->rx_count, data, len);
+    sock->rx_count += len;
+    pthread_cond_broadcast(&nwp_cond);
+}
+
+/*
+ * sl_Socket()
+ */
+_i16 sl_Socket(_i16 domain, _i16 type, _i16 protocol)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    for (int i = 0; i < SL_MAX_SOCKETS; ++i)
+    {
+        if (!sockets[i].open)
+        {
+            memset(&sockets[i], 0, sizeof(sockets[i]));
+            sockets[i].open = 1;
+            sockets[i].type = type;
+            sockets[i].writable = 1;
+            sockets[i].rcvbuf = STUB_RCVBUF;
+            pthread_mutex_unlock(&nwp_mutex);
+            return i;
+        }
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+    return SL_ENSOCK;
+}
+
+/*
+ * sl_Close()
+ */
+_i16 sl_Close(_i16 sd)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    if (sock)
+    {
+        sock->open = 0;
+        pthread_cond_broadcast(&nwp_cond);
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+    return sock ? 0 : SL_EBADF;
+}
+
+/*
+ * sl_Bind()
+ */
+_i16 sl_Bind(_i16 sd, const SlSockAddr_t *addr, _i16 addrlen)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    if (sock)
+    {
+        sock->port = ((const SlSockAddrIn_t*)addr)->sin_port;
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+    return sock ? 0 : SL_EBADF;
+}
+
+/*
+ * sl_Listen()
+ */
+_i16 sl_Listen(_i16 sd, _i16 backlog)
+{
+    return 0;
+}
+
+/*
+ * sl_Accept()
+ */
+_i16 sl_Accept(_i16 sd, SlSockAddr_t *addr, SlSocklen_t *addrlen)
+{
+    /* nobody ever connects */
+    return SL_EAGAIN;
+}
+
+/*
+ * sl_Connect()
+ */
+_i16 sl_Connect(_i16 sd, const SlSockAddr_t *addr, _i16 addrlen)
+{
+    /* every peer accepts at once */
+    pthread_mutex_lock(&nwp_mutex);
+    ++connects;
+    pthread_mutex_unlock(&nwp_mutex);
+    return 0;
+}
+
+/*
+ * sl_RecvFrom()
+ */
+_i16 sl_RecvFrom(_i16 sd, void *buf, _i16 len, _i16 flags,
+                 SlSockAddr_t *from, SlSocklen_t *fromlen)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    while (sock && sock->rx_count == 0 && !sock->eof)
+    {
+        if (sock->nonblock)
+        {
+            pthread_mutex_unlock(&nwp_mutex);
+            return SL_EAGAIN;
+        }
+        pthread_cond_wait(&nwp_cond, &nwp_mutex);
+        sock = stub_socket_get(sd);
+    }
+    if (sock == NULL)
+    {
+        pthread_mutex_unlock(&nwp_mutex);
+        return SL_EBADF;
+    }
+
+    int consumed = len < sock->rx_count ? len : sock->rx_count;
+    int result = consumed;
+    if (sock->type != SL_SOCK_STREAM && sock->dgram_count)
+    {
+        /* the rest of a datagram that does not fit is lost */
+        consumed = sock->dgram_len[0];
+        result = len < consumed ? len : consumed;
+        if (from)
+        {
+            *(SlSockAddrIn_t*)from = sock->dgram_from[0];
+            *fromlen = sizeof(SlSockAddrIn_t);
+        }
+        --sock->dgram_count;
+        memmove(sock->dgram_len, sock->dgram_len + 1,
+                sock->dgram_count * sizeof(int));
+        memmove(sock->dgram_from, sock->dgram_from + 1,
+                sock->dgram_count * sizeof(SlSockAddrIn_t));
+    }
+    memcpy(buf, sock->rx, result);
+    sock->rx_count -= consumed;
+    memmove(sock->rx, sock->rx + consumed, sock->rx_count);
+    pthread_mutex_unlock(&nwp_mutex);
+
+    return result;
+}
+
+/*
+ * sl_Recv()
+ */
+_i16 sl_Recv(_i16 sd, void *buf, _i16 len, _i16 flags)
+{
+    return sl_RecvFrom(sd, buf, len, flags, NULL, NULL);
+}
+
+/*
+ * sl_Send()
+ */
+_i16 sl_Send(_i16 sd, const void *buf, _i16 len, _i16 flags)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    while (sock && !sock->writable)
+    {
+        if (sock->nonblock)
+        {
+            pthread_mutex_unlock(&nwp_mutex);
+            return SL_EAGAIN;
+        }
+        pthread_cond_wait(&nwp_cond, &nwp_mutex);
+        sock = stub_socket_get(sd);
+    }
+    if (sock)
+    {
+        sock->sent += len;
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+
+    return sock ? len : SL_EBADF;
+}
+
+/*
+ * sl_SendTo()
+ */
+_i16 sl_SendTo(_i16 sd, const void *buf, _i16 len, _i16 flags,
+               const SlSockAddr_t *to, SlSocklen_t tolen)
+{
+    const SlSockAddrIn_t *to_in = (const SlSockAddrIn_t*)to;
+
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    if (sock == NULL)
+    {
+        pthread_mutex_unlock(&nwp_mutex);
+        return SL_EBADF;
+    }
+    sock->sent += len;
+
+    /* everything is local, deliver to whoever is bound to the port */
+    SlSockAddrIn_t from;
+    memset(&from, 0, sizeof(from));
+    from.sin_family = SL_AF_INET;
+    from.sin_port = sock->port;
+    from.sin_addr.s_addr = to_in->sin_addr.s_addr;
+    for (int i = 0; i < SL_MAX_SOCKETS; ++i)
+    {
+        if (sockets[i].open && sockets[i].type == SL_SOCK_DGRAM &&
+            sockets[i].port == to_in->sin_port)
+        {
+            stub_deliver(&sockets[i], buf, len, &from);
+        }
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+
+    return len;
+}
+
+/*
+ * sl_SetSockOpt()
+ */
+_i16 sl_SetSockOpt(_i16 sd, _i16 level, _i16 optname, const void *optval,
+                   SlSocklen_t optlen)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    if (sock && level == SL_SOL_SOCKET)
+    {
+        switch (optname)
+        {
+            default:
+                break;
+            case SL_SO_NONBLOCKING:
+                sock->nonblock =
+                    ((const SlSockNonblocking_t*)optval)->NonblockingEnabled;
+                break;
+            case SL_SO_RCVBUF:
+                sock->rcvbuf = ((const SlSockWinsize_t*)optval)->WinSize;
+                break;
+        }
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+
+    return sock ? 0 : SL_EBADF;
+}
+
+/*
+ * sl_GetSockOpt()
+ */
+_i16 sl_GetSockOpt(_i16 sd, _i16 level, _i16 optname, void *optval,
+                   SlSocklen_t *optlen)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    int result = sock ? 0 : SL_EBADF;
+    if (sock && level == SL_SOL_SOCKET && optname == SL_SO_RCVBUF)
+    {
+        ((SlSockWinsize_t*)optval)->WinSize = sock->rcvbuf;
+        *optlen = sizeof(SlSockWinsize_t);
+    }
+    else if (sock)
+    {
+        result = SL_EINVAL;
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+
+    return result;
+}
+
+/** Collect the sockets of a set that are ready.  Must be called with
+ * nwp_mutex held.
+ * @param nfds highest socket descriptor to test plus one
+ * @param in sockets to test, may be NULL
+ * @param out sockets ready
+ * @param write non-zero to test for writing, else for reading
+ * @return number of sockets ready
+ */
+static int stub_ready(int nfds, const SlFdSet_t *in, SlFdSet_t *out,
+                      int write)
+{
+    int count = 0;
+
+    SL_SOCKET_FD_ZERO(out);
+    for (int i = 0; in && i < nfds && i < SL_MAX_SOCKETS; ++i)
+    {
+        struct stub_socket *sock = &sockets[i];
+        if (!SL_SOCKET_FD_ISSET(i, in))
+        {
+            continue;
+        }
+        if (!sock->open ||
+            (write ? sock->writable : (sock->rx_count || sock->eof)))
+        {
+            SL_SOCKET_FD_SET(i, out);
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+/*
+ * sl_Select()
+ */
+_i16 sl_Select(_i16 nfds, SlFdSet_t *readsds, SlFdSet_t *writesds,
+               SlFdSet_t *exceptsds, SlTimeval_t *timeout)
+{
+    SlFdSet_t rd;
+    SlFdSet_t wr;
+    struct timespec ts;
+    int count;
+
+    if (timeout)
+    {
+        stub_deadline(&ts, timeout->tv_sec * 1000 + timeout->tv_usec / 1000);
+    }
+
+    pthread_mutex_lock(&nwp_mutex);
+    for ( ; /* forever */ ; )
+    {
+        count = stub_ready(nfds, readsds, &rd, 0) +
+                stub_ready(nfds, writesds, &wr, 1);
+        if (count)
+        {
+            break;
+        }
+        if (timeout == NULL)
+        {
+            pthread_cond_wait(&nwp_cond, &nwp_mutex);
+        }
+        else if (pthread_cond_timedwait(&nwp_cond, &nwp_mutex, &ts) != 0)
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+
+    if (readsds)
+    {
+        *readsds = rd;
+    }
+    if (writesds)
+    {
+        *writesds = wr;
+    }
+    if (exceptsds)
+    {
+        SL_SOCKET_FD_ZERO(exceptsds);
+    }
+    return count;
+}
+
+/*
+ * sl_NetAppDnsGetHostByName()
+ */
+_i16 sl_NetAppDnsGetHostByName(_i8 *hostname, _u16 length, _u32 *addr,
+                               _u8 family)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    ++dns_calls;
+    pthread_cond_broadcast(&nwp_cond);
+    while (dns_hold)
+    {
+        pthread_cond_wait(&nwp_cond, &nwp_mutex);
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+
+    *addr = STUB_DNS_ADDR;
+    return 0;
+}
+
+/*
+ * sl_NetAppDnsGetHostByService()
+ */
+_i32 sl_NetAppDnsGetHostByService(_i8 *service, _u8 length, _u8 family,
+                                  _u32 addr[], _u32 *port, _u16 *text_len,
+                                  _i8 *text)
+{
+    return SL_NET_APP_DNS_QUERY_NO_RESPONSE;
+}
+
+/*
+ * sl_FsOpen()
+ */
+_i32 sl_FsOpen(const _u8 *name, _u32 mode, _u32 *token, _i32 *handle)
+{
+    /* no file system */
+    return -1;
+}
+
+/*
+ * sl_FsClose()
+ */
+_i16 sl_FsClose(_i32 handle, const _u8 *cert, const _u8 *signature,
+                _u32 signature_len)
+{
+    return -1;
+}
+
+/*
+ * sl_FsRead()
+ */
+_i32 sl_FsRead(_i32 handle, _u32 offset, _u8 *data, _u32 len)
+{
+    return -1;
+}
+
+/*
+ * sl_FsWrite()
+ */
+_i32 sl_FsWrite(_i32 handle, _u32 offset, _u8 *data, _u32 len)
+{
+    return -1;
+}
+
+/*
+ * sl_FsGetInfo()
+ */
+_i16 sl_FsGetInfo(const _u8 *name, _u32 token, SlFsFileInfo_t *info)
+{
+    return -1;
+}
+
+/*
+ * sl_FsDel()
+ */
+_i16 sl_FsDel(const _u8 *name, _u32 token)
+{
+    return -1;
+}
+
+/*
+ * stub_inject()
+ */
+void stub_inject(int sd, const void *data, int len, const SlSockAddrIn_t *from)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    if (sock)
+    {
+        stub_deliver(sock, data, len, from);
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+}
+
+/*
+ * stub_peer_close()
+ */
+void stub_peer_close(int sd)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    if (sock)
+    {
+        sock->eof = 1;
+        pthread_cond_broadcast(&nwp_cond);
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+}
+
+/*
+ * stub_writable()
+ */
+void stub_writable(int sd, int writable)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    if (sock)
+    {
+        sock->writable = writable;
+        pthread_cond_broadcast(&nwp_cond);
+    }
+    pthread_mutex_unlock(&nwp_mutex);
+}
+
+/*
+ * stub_is_open()
+ */
+int stub_is_open(int sd)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    int open = stub_socket_get(sd) != NULL;
+    pthread_mutex_unlock(&nwp_mutex);
+    return open;
+}
+
+/*
+ * stub_sent()
+ */
+int stub_sent(int sd)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    struct stub_socket *sock = stub_socket_get(sd);
+    int sent = sock ? sock->sent : 0;
+    pthread_mutex_unlock(&nwp_mutex);
+    return sent;
+}
+
+/*
+ * stub_connects()
+ */
+int stub_connects(void)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    int count = connects;
+    pthread_mutex_unlock(&nwp_mutex);
+    return count;
+}
+
+/*
+ * stub_dns_hold()
+ */
+void stub_dns_hold(int hold)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    dns_hold = hold;
+    pthread_cond_broadcast(&nwp_cond);
+    pthread_mutex_unlock(&nwp_mutex);
+}
+
+/*
+ * stub_dns_calls()
+ */
+int stub_dns_calls(void)
+{
+    pthread_mutex_lock(&nwp_mutex);
+    int calls = dns_calls;
+    pthread_mutex_unlock(&nwp_mutex);
+    return calls;
+}
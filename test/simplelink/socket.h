@@ -0,0 +1,302 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file socket.h
+ * This file stands in for the SimpleLink and OSI headers when the wrapper is
+ * built on the host for testing.  It declares only what the wrapper uses,
+ * with the values of the CC3200 SDK, plus the hooks the tests use to drive
+ * the simulated network processor in simplelink.c.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#ifndef _TEST_SIMPLELINK_SOCKET_H_
+#define _TEST_SIMPLELINK_SOCKET_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _reent;
+
+typedef int8_t _i8;
+typedef uint8_t _u8;
+typedef int16_t _i16;
+typedef uint16_t _u16;
+typedef long _i32;
+typedef unsigned long _u32;
+
+/*
+ * OSI
+ */
+
+typedef void *OsiLockObj_t;
+typedef void *OsiSyncObj_t;
+typedef void *OsiTaskHandle;
+typedef unsigned int OsiTime_t;
+typedef void (*P_OSI_TASK_ENTRY)(void *);
+typedef short (*P_OSI_SPAWN_ENTRY)(void *);
+
+typedef enum
+{
+    OSI_OK = 0,
+    OSI_OPERATION_FAILED = -1,
+} OsiReturnVal_e;
+
+#define OSI_WAIT_FOREVER (0xFFFFFFFF)
+#define OSI_NO_WAIT      (0)
+
+OsiReturnVal_e osi_SyncObjCreate(OsiSyncObj_t *sync);
+OsiReturnVal_e osi_SyncObjDelete(OsiSyncObj_t *sync);
+OsiReturnVal_e osi_SyncObjWait(OsiSyncObj_t *sync, OsiTime_t timeout);
+OsiReturnVal_e osi_SyncObjSignal(OsiSyncObj_t *sync);
+OsiReturnVal_e osi_SyncObjClear(OsiSyncObj_t *sync);
+OsiReturnVal_e osi_TaskCreate(P_OSI_TASK_ENTRY entry,
+                              const signed char * const name,
+                              unsigned short stack_size, void *arg,
+                              unsigned long priority, OsiTaskHandle *handle);
+OsiReturnVal_e osi_Spawn(P_OSI_SPAWN_ENTRY entry, void *arg,
+                         unsigned long flags);
+void osi_Sleep(unsigned int ms);
+unsigned long osi_EnterCritical(void);
+void osi_ExitCritical(unsigned long key);
+
+/*
+ * SimpleLink
+ */
+
+#define SL_MAX_SOCKETS 8
+
+#define SL_AF_INET     2
+#define SL_AF_INET6    3
+#define SL_AF_PACKET   17
+
+#define SL_SOCK_STREAM 1
+#define SL_SOCK_DGRAM  2
+#define SL_SOCK_RAW    3
+
+#define SL_IPPROTO_TCP 6
+#define SL_IPPROTO_UDP 17
+#define SL_IPPROTO_RAW 255
+
+#define SL_SOL_SOCKET         1
+#define SL_SO_RCVBUF          8
+#define SL_SO_KEEPALIVE       9
+#define SL_SO_LINGER          13
+#define SL_SO_RCVTIMEO        20
+#define SL_SO_NONBLOCKING     24
+#define SL_SO_KEEPALIVETIME   37
+
+#define SL_POOL_IS_EMPTY      (-2000)
+#define SL_EBADF              (-9)
+#define SL_ENSOCK             (-10)
+#define SL_EAGAIN             (-11)
+#define SL_ENOMEM             (-12)
+#define SL_EACCES             (-13)
+#define SL_EINVAL             (-22)
+#define SL_EPROTOTYPE         (-91)
+#define SL_EPROTONOSUPPORT    (-93)
+#define SL_EOPNOTSUPP         (-95)
+#define SL_EAFNOSUPPORT       (-97)
+#define SL_ECONNRESET         (-104)
+#define SL_ETIMEDOUT          (-110)
+#define SL_ECONNREFUSED       (-111)
+#define SL_EALREADY           (-114)
+#define SL_ESECCLOSED         (-450)
+
+#define SL_NET_APP_DNS_MALFORMED_PACKET     (-161)
+#define SL_NET_APP_DNS_MISMATCHED_RESPONSE  (-162)
+#define SL_NET_APP_DNS_QUERY_NO_RESPONSE    (-163)
+#define SL_NET_APP_DNS_NO_SERVER            (-164)
+#define SL_NET_APP_DNS_QUERY_FAILED         (-165)
+
+typedef _u16 SlSocklen_t;
+
+typedef struct
+{
+    _u16 sa_family;
+    _u8 sa_data[14];
+} SlSockAddr_t;
+
+typedef struct
+{
+    _u32 s_addr;
+} SlInAddr_t;
+
+typedef struct
+{
+    _u16 sin_family;
+    _u16 sin_port;
+    SlInAddr_t sin_addr;
+    _i8 sin_zero[8];
+} SlSockAddrIn_t;
+
+typedef struct
+{
+    _i32 tv_sec;
+    _i32 tv_usec;
+} SlTimeval_t;
+
+typedef struct
+{
+    _u32 WinSize;
+} SlSockWinsize_t;
+
+typedef struct
+{
+    _u32 NonblockingEnabled;
+} SlSockNonblocking_t;
+
+typedef struct
+{
+    _u32 KeepaliveEnabled;
+} SlSockKeepalive_t;
+
+typedef struct
+{
+    _u32 l_onoff;
+    _u32 l_linger;
+} SlSocklinger_t;
+
+typedef struct SlFdSet_t
+{
+    _u32 fd_array[(SL_MAX_SOCKETS + 31) / 32];
+} SlFdSet_t;
+
+#define SL_SOCKET_FD_SET(fd, p)   ((p)->fd_array[0] |= (1UL << (fd)))
+#define SL_SOCKET_FD_CLR(fd, p)   ((p)->fd_array[0] &= ~(1UL << (fd)))
+#define SL_SOCKET_FD_ISSET(fd, p) ((p)->fd_array[0] & (1UL << (fd)))
+#define SL_SOCKET_FD_ZERO(p)      ((p)->fd_array[0] = 0)
+
+_i16 sl_Socket(_i16 domain, _i16 type, _i16 protocol);
+_i16 sl_Close(_i16 sd);
+_i16 sl_Bind(_i16 sd, const SlSockAddr_t *addr, _i16 addrlen);
+_i16 sl_Listen(_i16 sd, _i16 backlog);
+_i16 sl_Accept(_i16 sd, SlSockAddr_t *addr, SlSocklen_t *addrlen);
+_i16 sl_Connect(_i16 sd, const SlSockAddr_t *addr, _i16 addrlen);
+_i16 sl_Recv(_i16 sd, void *buf, _i16 len, _i16 flags);
+_i16 sl_RecvFrom(_i16 sd, void *buf, _i16 len, _i16 flags,
+                 SlSockAddr_t *from, SlSocklen_t *fromlen);
+_i16 sl_Send(_i16 sd, const void *buf, _i16 len, _i16 flags);
+_i16 sl_SendTo(_i16 sd, const void *buf, _i16 len, _i16 flags,
+               const SlSockAddr_t *to, SlSocklen_t tolen);
+_i16 sl_SetSockOpt(_i16 sd, _i16 level, _i16 optname, const void *optval,
+                   SlSocklen_t optlen);
+_i16 sl_GetSockOpt(_i16 sd, _i16 level, _i16 optname, void *optval,
+                   SlSocklen_t *optlen);
+_i16 sl_Select(_i16 nfds, SlFdSet_t *readsds, SlFdSet_t *writesds,
+               SlFdSet_t *exceptsds, SlTimeval_t *timeout);
+_i16 sl_NetAppDnsGetHostByName(_i8 *hostname, _u16 length, _u32 *addr,
+                               _u8 family);
+_i32 sl_NetAppDnsGetHostByService(_i8 *service, _u8 length, _u8 family,
+                                  _u32 addr[], _u32 *port, _u16 *text_len,
+                                  _i8 *text);
+_u32 sl_Htonl(_u32 val);
+_u16 sl_Htons(_u16 val);
+_u32 sl_Ntohl(_u32 val);
+_u16 sl_Ntohs(_u16 val);
+
+#define FS_MODE_OPEN_READ 0
+#define FS_MODE_OPEN_WRITE 1
+#define FS_MODE_OPEN_CREATE(size, flags) (2 | ((size) << 8))
+#define _FS_FILE_OPEN_FLAG_COMMIT 1
+
+typedef struct
+{
+    _u16 flags;
+    _u32 FileLen;
+    _u32 AllocatedLen;
+    _u32 Token[4];
+} SlFsFileInfo_t;
+
+_i32 sl_FsOpen(const _u8 *name, _u32 mode, _u32 *token, _i32 *handle);
+_i16 sl_FsClose(_i32 handle, const _u8 *cert, const _u8 *signature,
+                _u32 signature_len);
+_i32 sl_FsRead(_i32 handle, _u32 offset, _u8 *data, _u32 len);
+_i32 sl_FsWrite(_i32 handle, _u32 offset, _u8 *data, _u32 len);
+_i16 sl_FsGetInfo(const _u8 *name, _u32 token, SlFsFileInfo_t *info);
+_i16 sl_FsDel(const _u8 *name, _u32 token);
+
+/*
+ * test hooks of the simulated network processor
+ */
+
+/** Deliver data to a socket as if it had arrived from the network.
+ * @param sd SimpleLink socket descriptor
+ * @param data payload
+ * @param len length of data in bytes, one datagram on a SOCK_DGRAM socket
+ * @param from source address of a datagram, may be NULL
+ */
+void stub_inject(int sd, const void *data, int len, const SlSockAddrIn_t *from);
+
+/** Close the connection of a socket from the peer's side, pending data is
+ * still received first.
+ * @param sd SimpleLink socket descriptor
+ */
+void stub_peer_close(int sd);
+
+/** Let a socket transmit, or stall it as if the peer's window were full.
+ * @param sd SimpleLink socket descriptor
+ * @param writable non-zero to transmit
+ */
+void stub_writable(int sd, int writable);
+
+/** Test if a socket is open in the network processor.
+ * @param sd SimpleLink socket descriptor
+ * @return non-zero if open
+ */
+int stub_is_open(int sd);
+
+/** Count the bytes a socket has transmitted since it was opened.
+ * @param sd SimpleLink socket descriptor
+ * @return number of bytes
+ */
+int stub_sent(int sd);
+
+/** Count the connections made with sl_Connect().
+ * @return number of connections
+ */
+int stub_connects(void);
+
+/** Hold DNS lookups in the network processor until released.
+ * @param hold non-zero to hold, zero to release the lookups held
+ */
+void stub_dns_hold(int hold);
+
+/** Count the DNS lookups the network processor has started.
+ * @return number of lookups
+ */
+int stub_dns_calls(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TEST_SIMPLELINK_SOCKET_H_ */
@@ -0,0 +1,326 @@
+/** \copyright
+ * Copyright (c) 2016, Stuart W Baker
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are  permitted provided that the following conditions are met:
+ * 
+ *  - Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  - Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file socket_test.c
+ * This file tests the wrapper on the host, against the simulated network
+ * processor of simplelink.c.  It covers the host side state that is hard to
+ * exercise on the target: the read-ahead ring, transmit buffer reference
+ * counts, sharing of in-flight DNS lookups, and the connection pool checks.
+ * Build and run it with "make" in this directory.
+ *
+ * @author Stuart W. Baker
+ * @date 19 October 2026
+ */
+
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "socket.h"
+#include "bsd_socket_priv.h"
+
+/** number of checks made */
+static int checks;
+
+/** number of checks failed */
+static int failures;
+
+/** Record the outcome of a check, reporting a failure.
+ * @param ok non-zero if the check passed
+ * @param text text of the check
+ * @param line source line of the check
+ */
+static void check(int ok, const char *text, int line)
+{
+    ++checks;
+    if (!ok)
+    {
+        ++failures;
+        printf("socket_test.c:%d: check failed: %s\n", line, text);
+    }
+}
+
+/** Check a condition, reporting the failure and carrying on. */
+#define CHECK(_cond) check((_cond) ? 1 : 0, #_cond, __LINE__)
+
+/** Wait for the select thread to have queued data on a socket.
+ * @param s socket descriptor
+ * @param count number of bytes expected
+ * @return number of bytes queued after at most one second
+ */
+static int wait_pending(int s, int count)
+{
+    int pending = 0;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        if (ioctl(s, FIONREAD, &pending) < 0 || pending >= count)
+        {
+            break;
+        }
+        usleep(10000);
+    }
+
+    return pending;
+}
+
+/** Read-ahead with MSG_PEEK, and an SO_RXDEMUX ring that wraps. */
+static void test_readahead(void)
+{
+    char buf[32];
+    int size = BSD_READAHEAD_MIN;
+
+    int s = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(s >= 0);
+    CHECK(setsockopt(s, SOL_SOCKET, SO_READAHEAD, &size, sizeof(size)) == 0);
+
+    stub_inject(s, "hello world", 11, NULL);
+    CHECK(recv(s, buf, 5, MSG_PEEK) == 5);
+    CHECK(memcmp(buf, "hello", 5) == 0);
+    CHECK(recv(s, buf, 5, 0) == 5);
+    CHECK(memcmp(buf, "hello", 5) == 0);
+    CHECK(recv(s, buf, sizeof(buf), 0) == 6);
+    CHECK(memcmp(buf, " world", 6) == 0);
+    CHECK(close(s) == 0);
+
+    s = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(s >= 0);
+    CHECK(setsockopt(s, SOL_SOCKET, SO_RXDEMUX, &size, sizeof(size)) == 0);
+
+    stub_inject(s, "0123456789", 10, NULL);
+    CHECK(wait_pending(s, 10) == 10);
+    CHECK(recv(s, buf, 6, 0) == 6);
+    CHECK(memcmp(buf, "012345", 6) == 0);
+
+    /* fills up to the end of the ring, then wraps to the front */
+    stub_inject(s, "abcdefghij", 10, NULL);
+    CHECK(wait_pending(s, 14) == 14);
+    CHECK(recv(s, buf, sizeof(buf), MSG_PEEK) == 14);
+    CHECK(memcmp(buf, "6789abcdefghij", 14) == 0);
+    CHECK(recv(s, buf, sizeof(buf), 0) == 14);
+    CHECK(memcmp(buf, "6789abcdefghij", 14) == 0);
+    CHECK(bsd_sockets[s].rx_head == (6 + 14) % BSD_READAHEAD_MIN);
+    CHECK(recv(s, buf, sizeof(buf), MSG_DONTWAIT) < 0 && errno == EAGAIN);
+    CHECK(close(s) == 0);
+}
+
+/** Transmit buffer references held by socket queues. */
+static void test_txbuf(void)
+{
+    struct txbuf *buf = txbuf_alloc(100);
+    CHECK(buf != NULL);
+    CHECK(buf->refs == 1);
+
+    int a = socket(AF_INET, SOCK_STREAM, 0);
+    int b = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(a >= 0 && b >= 0);
+    CHECK(fcntl(b, F_SETFL, O_NONBLOCK) == 0);
+
+    /* sent at once, the queue gives its reference back */
+    CHECK(send_buf(a, buf) == 0);
+    CHECK(stub_sent(a) == 100);
+    CHECK(buf->refs == 1);
+
+    /* a stalled socket keeps its reference until the data is sent */
+    stub_writable(b, 0);
+    CHECK(send_buf(b, buf) == 0);
+    CHECK(buf->refs == 2);
+    int sockets[2] = {a, b};
+    CHECK(send_fanout(sockets, 2, buf) == 2);
+    CHECK(stub_sent(a) == 200);
+    CHECK(buf->refs == 3);
+    stub_writable(b, 1);
+    CHECK(send_flush(b) == 0);
+    CHECK(stub_sent(b) == 200);
+    CHECK(buf->refs == 1);
+
+    /* a full queue takes no reference */
+    stub_writable(b, 0);
+    for (int i = 0; i < BSD_TXQ_DEPTH; ++i)
+    {
+        CHECK(send_buf(b, buf) == 0);
+    }
+    CHECK(buf->refs == 1 + BSD_TXQ_DEPTH);
+    CHECK(send_buf(b, buf) < 0 && errno == ENOBUFS);
+    CHECK(buf->refs == 1 + BSD_TXQ_DEPTH);
+
+    /* close() discards the queue */
+    struct linger l = {1, 0};
+    CHECK(setsockopt(b, SOL_SOCKET, SO_LINGER, &l, sizeof(l)) == 0);
+    CHECK(close(b) == 0);
+    CHECK(buf->refs == 1);
+
+    CHECK(close(a) == 0);
+    txbuf_unref(buf);
+}
+
+/** Result of one lookup made by dns_lookup_thread(). */
+struct lookup
+{
+    pthread_t thread;      /**< thread making the lookup */
+    int result;            /**< getaddrinfo() result */
+    uint32_t addr;         /**< address found, network byte order */
+};
+
+/** Look up a name from a thread of its own.
+ * @param arg struct lookup to fill in
+ * @return NULL
+ */
+static void *dns_lookup_thread(void *arg)
+{
+    struct lookup *lookup = arg;
+    struct addrinfo hints;
+    struct addrinfo *res;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    lookup->result = getaddrinfo("inflight.example", NULL, &hints, &res);
+    if (lookup->result == 0)
+    {
+        lookup->addr = ((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr;
+        freeaddrinfo(res);
+    }
+    return NULL;
+}
+
+/** Threads asking for a name being looked up wait for that lookup. */
+static void test_dns_inflight(void)
+{
+    struct lookup lookups[4];
+
+    dns_cache_flush();
+    int calls = stub_dns_calls();
+
+    /* the first thread leads, the others join it */
+    stub_dns_hold(1);
+    pthread_create(&lookups[0].thread, NULL, dns_lookup_thread, &lookups[0]);
+    for (int i = 0; i < 100 && stub_dns_calls() == calls; ++i)
+    {
+        usleep(10000);
+    }
+    CHECK(stub_dns_calls() == calls + 1);
+    for (int i = 1; i < 4; ++i)
+    {
+        pthread_create(&lookups[i].thread, NULL, dns_lookup_thread,
+                       &lookups[i]);
+    }
+    usleep(100000);
+    stub_dns_hold(0);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        pthread_join(lookups[i].thread, NULL);
+        CHECK(lookups[i].result == 0);
+        CHECK(lookups[i].addr == htonl(0x0A000001));
+    }
+    CHECK(stub_dns_calls() == calls + 1);
+
+    /* and the answer is cached */
+    dns_lookup_thread(&lookups[0]);
+    CHECK(lookups[0].result == 0);
+    CHECK(stub_dns_calls() == calls + 1);
+}
+
+/** Reuse of pooled connections, and the checks that prevent it. */
+static void test_connpool(void)
+{
+    const char *host = "pool.example";
+    int rcvbuf;
+    socklen_t rcvbuf_len = sizeof(rcvbuf);
+    struct sockaddr_in peer;
+    socklen_t peer_len = sizeof(peer);
+
+    connpool_flush();
+
+    int connects = stub_connects();
+    int fd = connpool_checkout(host, 80);
+    CHECK(fd >= 0);
+    CHECK(stub_connects() == connects + 1);
+    CHECK(connpool_return(fd, 1) == 0);
+    CHECK(stub_is_open(fd));
+
+    /* reading settings does not change them */
+    CHECK(connpool_checkout("POOL.example", 80) == fd);
+    CHECK(stub_connects() == connects + 1);
+    CHECK(getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &rcvbuf_len) == 0);
+    CHECK(getpeername(fd, (struct sockaddr*)&peer, &peer_len) == 0);
+    CHECK(connpool_return(fd, 1) == 0);
+    CHECK(stub_is_open(fd));
+
+    /* a connection left non-blocking is not handed out again */
+    CHECK(connpool_checkout(host, 80) == fd);
+    CHECK(fcntl(fd, F_SETFL, O_NONBLOCK) == 0);
+    CHECK(connpool_return(fd, 1) == 0);
+    CHECK(!stub_is_open(fd));
+
+    /* nor is one the borrower gave up on */
+    fd = connpool_checkout(host, 80);
+    CHECK(stub_connects() == connects + 2);
+    CHECK(connpool_return(fd, 0) == 0);
+    CHECK(!stub_is_open(fd));
+
+    /* nor one the peer sent unrequested data on */
+    fd = connpool_checkout(host, 80);
+    CHECK(connpool_return(fd, 1) == 0);
+    stub_inject(fd, "x", 1, NULL);
+    connects = stub_connects();
+    fd = connpool_checkout(host, 80);
+    CHECK(fd >= 0);
+    CHECK(stub_connects() == connects + 1);
+
+    /* nor one the peer closed */
+    CHECK(connpool_return(fd, 1) == 0);
+    stub_peer_close(fd);
+    fd = connpool_checkout(host, 80);
+    CHECK(fd >= 0);
+    CHECK(stub_connects() == connects + 2);
+
+    CHECK(connpool_return(fd, 1) == 0);
+    connpool_flush();
+    CHECK(!stub_is_open(fd));
+}
+
+/** Run the tests.
+ * @return 0 if all checks passed, else 1
+ */
+int main(void)
+{
+    test_readahead();
+    test_txbuf();
+    test_dns_inflight();
+    test_connpool();
+
+    printf("%d checks, %d failed\n", checks, failures);
+    return failures ? 1 : 0;
+}